@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "biblioteca.h"
+
+// Compara el costo por movimiento de las formas de enviar comandos: un write por
+// comando, un write por movimiento, un writev por programa y el anillo en memoria
+// compartida. Por defecto escribe en un dispositivo falso (Biblioteca_OpenMock) y el
+// anillo lo consume un hilo de prueba (Biblioteca_RingAbrirMock), así se mide sin
+// hardware; con --dispositivo usa el driver de verdad. --escala es cuánto tarda cada
+// comando del consumidor de prueba respecto del pulso real (0 = instantáneo).
+//   ./bench_biblioteca [ruta] [--dispositivo] [--escala X] [movimientos] [pasos]
+
+static double ahora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void reportar(const char *forma, int movimientos, double t_us) {
+    Biblioteca_Contadores c;
+    Biblioteca_LeerContadores(&c);
+    printf("%-16s %8.2f syscalls/movimiento %10.2f us/movimiento (%lu bytes)\n",
+           forma, (double)c.syscalls / movimientos, t_us / movimientos, c.bytes);
+}
+
+int main(int argc, char *argv[]) {
+    const char *ruta = "robotic_hand.mock";
+    int dispositivo = 0, movimientos = 1000, pasos = 50;
+    double escala = 0;
+    int posicional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--dispositivo") == 0) {
+            dispositivo = 1;
+        } else if (strcmp(argv[i], "--escala") == 0 && i + 1 < argc) {
+            escala = atof(argv[++i]);
+        } else if (posicional == 0) {
+            ruta = argv[i];
+            posicional++;
+        } else if (posicional == 1) {
+            movimientos = atoi(argv[i]);
+            posicional++;
+        } else {
+            pasos = atoi(argv[i]);
+        }
+    }
+    if (movimientos < 1 || pasos < 1) {
+        fprintf(stderr, "Uso: %s [ruta] [--dispositivo] [--escala X] [movimientos] [pasos]\n", argv[0]);
+        return 1;
+    }
+
+    BD fd = dispositivo ? Biblioteca_Open(ruta) : Biblioteca_OpenMock(ruta);
+    if (fd < 0) return 1;
+
+    // Un movimiento de 'pasos' comandos: diagonal en escalera + bajar/subir al final
+    Cmd *movimiento = malloc(pasos);
+    if (!movimiento) return 1;
+    for (int i = 0; i < pasos; ++i) movimiento[i] = "ADAD"[i % 4];
+    movimiento[pasos - 1] = 'B';
+    printf("%d movimientos de %d pasos sobre '%s'\n", movimientos, pasos, ruta);
+
+    // 1. Un write por comando
+    Biblioteca_ReiniciarContadores();
+    double t0 = ahora_us();
+    for (int m = 0; m < movimientos; ++m) {
+        for (int i = 0; i < pasos; ++i) {
+            if (Biblioteca_SendCommand(fd, movimiento[i]) != 0) return 1;
+        }
+    }
+    reportar("SendCommand", movimientos, ahora_us() - t0);
+
+    // 2. Un write por movimiento
+    Biblioteca_ReiniciarContadores();
+    t0 = ahora_us();
+    for (int m = 0; m < movimientos; ++m) {
+        if (Biblioteca_SendCommands(fd, movimiento, pasos) != 0) return 1;
+    }
+    reportar("SendCommands", movimientos, ahora_us() - t0);
+
+    // 3. Programa de varios movimientos, un writev cada BIBLIOTECA_MAX_TRAMOS movimientos
+    Biblioteca_ReiniciarContadores();
+    t0 = ahora_us();
+    Biblioteca_Programa prog;
+    Biblioteca_ProgramaIniciar(&prog);
+    for (int m = 0; m < movimientos; ++m) {
+        if (prog.num_tramos == BIBLIOTECA_MAX_TRAMOS) {
+            if (Biblioteca_ProgramaEnviar(fd, &prog) != 0) return 1;
+            Biblioteca_ProgramaIniciar(&prog);
+        }
+        Biblioteca_ProgramaAgregar(&prog, movimiento, pasos);
+    }
+    if (Biblioteca_ProgramaEnviar(fd, &prog) != 0) return 1;
+    reportar("ProgramaEnviar", movimientos, ahora_us() - t0);
+
+    // 4. Anillo: se encola lo que entra sin esperar y se cosecha lo que haya; solo se
+    //    duerme (hasta medio anillo de completados) si sq está lleno o ya se envió todo
+    Biblioteca_Ring *ring = dispositivo ? Biblioteca_RingAbrir(fd) : Biblioteca_RingAbrirMock(escala);
+    if (!ring) return 1;
+    struct rh_sqe *paso = calloc(pasos, sizeof(*paso));
+    struct rh_sqe *lote = calloc(pasos, sizeof(*lote));
+    struct rh_cqe completados[RH_RING_ENTRADAS];
+    if (!paso || !lote) return 1;
+    for (int i = 0; i < pasos; ++i) {
+        paso[i].ejes = 1u << (strchr(RH_LETRAS_EJES, movimiento[i]) - RH_LETRAS_EJES);
+    }
+    int rc = 0;
+    unsigned long long total = (unsigned long long)movimientos * pasos, enviados = 0, recibidos = 0;
+    Biblioteca_ReiniciarContadores();
+    t0 = ahora_us();
+    while (recibidos < total && rc == 0) {
+        int puestos = 0;
+        if (enviados < total) {
+            int n = 0;
+            while (n < pasos && enviados + n < total) {
+                lote[n] = paso[(enviados + n) % pasos];
+                lote[n].user_data = enviados + n;
+                n++;
+            }
+            puestos = Biblioteca_RingSubmit(ring, lote, n);
+            if (puestos < 0) return 1;
+            enviados += puestos;
+        }
+        unsigned int minimo = 0;
+        if (puestos == 0 || enviados == total) {
+            minimo = RH_RING_ENTRADAS / 2;
+            if (total - recibidos < minimo) minimo = total - recibidos;
+        }
+        int n = Biblioteca_RingReap(ring, completados, RH_RING_ENTRADAS, minimo);
+        if (n < 0) return 1;
+        for (int i = 0; i < n && rc == 0; ++i, ++recibidos) {
+            if (completados[i].user_data != recibidos || completados[i].resultado != 0) {
+                fprintf(stderr, "Error: el completado %llu llegó como %llu (resultado %d)\n", recibidos,
+                        (unsigned long long)completados[i].user_data, completados[i].resultado);
+                rc = 1;
+            }
+        }
+    }
+    reportar("RingSubmit", movimientos, ahora_us() - t0);
+    if (rc == 0) printf("Anillo verificado: %llu completados en orden.\n", recibidos);
+    Biblioteca_RingCerrar(ring);
+    free(paso);
+    free(lote);
+
+    // El dispositivo falso tiene que tener los tres envíos completos y en orden
+    if (!dispositivo) {
+        off_t esperado = (off_t)3 * movimientos * pasos;
+        off_t largo = lseek(fd, 0, SEEK_END);
+        if (largo != esperado) {
+            fprintf(stderr, "Error: el dispositivo falso tiene %lld bytes, se esperaban %lld\n",
+                    (long long)largo, (long long)esperado);
+            rc = 1;
+        }
+        Cmd *leido = malloc(pasos);
+        lseek(fd, 0, SEEK_SET);
+        for (off_t m = 0; rc == 0 && m < 3 * (off_t)movimientos; ++m) {
+            if (read(fd, leido, pasos) != pasos || memcmp(leido, movimiento, pasos) != 0) {
+                fprintf(stderr, "Error: el movimiento %lld llegó alterado\n", (long long)m);
+                rc = 1;
+            }
+        }
+        free(leido);
+        if (rc == 0) printf("Dispositivo falso verificado: %lld comandos en orden.\n", (long long)esperado);
+    }
+
+    free(movimiento);
+    Biblioteca_Close(fd);
+    return rc;
+}
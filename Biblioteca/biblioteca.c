@@ -1,15 +1,45 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
 #include "biblioteca.h"
 
+static Biblioteca_Contadores contadores;
+
 BD Biblioteca_Open(const char *device_path) {
     BD fd = open(device_path, O_RDWR);
     if (fd < 0) perror("Biblioteca_Open");
     return fd;
 }
 
+BD Biblioteca_OpenHand(int mano) {
+    char ruta[32];
+
+    if (mano < 0) {
+        errno = EINVAL;
+        perror("Biblioteca_OpenHand");
+        return -1;
+    }
+    if (mano == 0) return Biblioteca_Open(RH_DISPOSITIVO);
+    snprintf(ruta, sizeof(ruta), RH_DISPOSITIVO "%d", mano);
+    return Biblioteca_Open(ruta);
+}
+
+BD Biblioteca_OpenMock(const char *file_path) {
+    BD fd = open(file_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) perror("Biblioteca_OpenMock");
+    return fd;
+}
+
 int Biblioteca_Close(BD fd) {
     if (close(fd) < 0) {
         perror("Biblioteca_Close");
@@ -20,10 +50,12 @@ int Biblioteca_Close(BD fd) {
 
 int Biblioteca_SendCommand(BD fd, Cmd cmd) {
     ssize_t n = write(fd, &cmd, 1);
+    contadores.syscalls++;
     if (n < 0) {
         perror("Biblioteca_SendCommand");
         return -1;
     }
+    contadores.bytes += n;
     if (n != 1) {
         fprintf(stderr, "Biblioteca_SendCommand: enviado != 1 byte\n");
         return -1;
@@ -31,6 +63,368 @@ int Biblioteca_SendCommand(BD fd, Cmd cmd) {
     return 0;
 }
 
+int Biblioteca_SendCommandsParcial(BD fd, const Cmd *cmds, size_t n, size_t *aceptados) {
+    size_t total = 0;
+    int ret = 0;
+    while (total < n) {
+        ssize_t enviados = write(fd, cmds + total, n - total);
+        contadores.syscalls++;
+        if (enviados < 0) {
+            if (errno == EINTR) continue;
+            perror("Biblioteca_SendCommands");
+            ret = -1;
+            break;
+        }
+        contadores.bytes += enviados;
+        total += enviados;
+    }
+    if (aceptados) *aceptados = total;
+    return ret;
+}
+
+int Biblioteca_SendCommands(BD fd, const Cmd *cmds, size_t n) {
+    return Biblioteca_SendCommandsParcial(fd, cmds, n, NULL);
+}
+
+size_t Biblioteca_CodificarEjes(Cmd *destino, unsigned int ejes, const unsigned short ms[RH_NUM_EJES]) {
+    if (ejes == 0 || (ejes & ~RH_MASCARA_EJES)) return 0;
+    size_t n = 0;
+    destino[n++] = (Cmd)(RH_OP_EJES | ejes);
+    for (int e = 0; e < RH_NUM_EJES; ++e) {
+        if (!(ejes & (1u << e))) continue;
+        destino[n++] = (Cmd)(ms[e] & 0xFF); // __le16
+        destino[n++] = (Cmd)(ms[e] >> 8);
+    }
+    return n;
+}
+
+size_t Biblioteca_CodificarPasos(Cmd *destino, unsigned int eje, unsigned short pasos) {
+    if (eje >= RH_NUM_EJES) return 0;
+    destino[0] = (Cmd)(RH_OP_PASOS | eje);
+    destino[1] = (Cmd)(pasos & 0xFF); // __le16
+    destino[2] = (Cmd)(pasos >> 8);
+    return 3;
+}
+
+int Biblioteca_Move(BD fd, unsigned int eje, unsigned short ms) {
+    unsigned short duraciones[RH_NUM_EJES] = { 0 };
+    if (eje >= RH_NUM_EJES) {
+        fprintf(stderr, "Biblioteca_Move: eje inválido %u\n", eje);
+        return -1;
+    }
+    duraciones[eje] = ms;
+    return Biblioteca_MoveAxes(fd, 1u << eje, duraciones);
+}
+
+int Biblioteca_MoveSteps(BD fd, unsigned int eje, unsigned short pasos) {
+    Cmd comando[3];
+    if (Biblioteca_CodificarPasos(comando, eje, pasos) == 0) {
+        fprintf(stderr, "Biblioteca_MoveSteps: eje inválido %u\n", eje);
+        return -1;
+    }
+    return Biblioteca_SendCommands(fd, comando, sizeof(comando));
+}
+
+int Biblioteca_ConfigurarEje(BD fd, unsigned int eje, unsigned int pulso_ms, unsigned int pausa_ms) {
+    struct rh_config_eje config = { .eje = eje, .pulso_ms = pulso_ms, .pausa_ms = pausa_ms };
+    if (ioctl(fd, RH_IOC_SET_EJE, &config) < 0) {
+        perror("Biblioteca_ConfigurarEje");
+        return -1;
+    }
+    return 0;
+}
+
+int Biblioteca_LeerConfigEje(BD fd, unsigned int eje, unsigned int *pulso_ms, unsigned int *pausa_ms) {
+    struct rh_config_eje config = { .eje = eje };
+    if (ioctl(fd, RH_IOC_GET_EJE, &config) < 0) {
+        perror("Biblioteca_LeerConfigEje");
+        return -1;
+    }
+    if (pulso_ms) *pulso_ms = config.pulso_ms;
+    if (pausa_ms) *pausa_ms = config.pausa_ms;
+    return 0;
+}
+
+int Biblioteca_MoveAxes(BD fd, unsigned int ejes, const unsigned short ms[RH_NUM_EJES]) {
+    Cmd comando[RH_MAX_COMANDO];
+    size_t n = Biblioteca_CodificarEjes(comando, ejes, ms);
+    if (n == 0) {
+        fprintf(stderr, "Biblioteca_MoveAxes: máscara de ejes inválida 0x%x\n", ejes);
+        return -1;
+    }
+    return Biblioteca_SendCommands(fd, comando, n);
+}
+
+void Biblioteca_ProgramaIniciar(Biblioteca_Programa *prog) {
+    prog->num_tramos = 0;
+    prog->total = 0;
+}
+
+int Biblioteca_ProgramaAgregar(Biblioteca_Programa *prog, const Cmd *cmds, size_t n) {
+    if (n == 0) return 0;
+    if (prog->num_tramos == BIBLIOTECA_MAX_TRAMOS) {
+        fprintf(stderr, "Biblioteca_ProgramaAgregar: el programa ya tiene %d tramos\n", BIBLIOTECA_MAX_TRAMOS);
+        return -1;
+    }
+    prog->tramos[prog->num_tramos].iov_base = (void *)cmds;
+    prog->tramos[prog->num_tramos].iov_len = n;
+    prog->num_tramos++;
+    prog->total += n;
+    return 0;
+}
+
+int Biblioteca_ProgramaEnviar(BD fd, const Biblioteca_Programa *prog) {
+    // Copia local de los tramos: si el driver acepta una parte, se avanza sobre ella
+    struct iovec tramos[BIBLIOTECA_MAX_TRAMOS];
+    int primero = 0, num = prog->num_tramos;
+    memcpy(tramos, prog->tramos, num * sizeof(struct iovec));
+
+    while (primero < num) {
+        ssize_t enviados = writev(fd, tramos + primero, num - primero);
+        contadores.syscalls++;
+        if (enviados < 0) {
+            if (errno == EINTR) continue;
+            perror("Biblioteca_ProgramaEnviar");
+            return -1;
+        }
+        contadores.bytes += enviados;
+        while (primero < num && (size_t)enviados >= tramos[primero].iov_len) {
+            enviados -= tramos[primero].iov_len;
+            primero++;
+        }
+        if (primero < num) {
+            tramos[primero].iov_base = (char *)tramos[primero].iov_base + enviados;
+            tramos[primero].iov_len -= enviados;
+        }
+    }
+    return 0;
+}
+
+// --- Anillo de comandos ---
+// Protocolo descrito en robotic_hand_cmd.h. Cada lado publica su índice con release y
+// lee el del otro con acquire; los pedidos de "despertame" (sq_flags, cq_esperando) van
+// con una barrera completa entre anotarlos y volver a mirar el anillo, igual que en el driver.
+#define RING_MASCARA (RH_RING_ENTRADAS - 1)
+#define MOCK_PULSO_MS 100 // PULSE_MS del driver
+
+#define CARGAR(p)       __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define PUBLICAR(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define FLAGS(p)        __atomic_load_n(p, __ATOMIC_RELAXED)
+#define FIJAR(p, v)     __atomic_store_n(p, v, __ATOMIC_RELAXED)
+#define BARRERA()       __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+struct Biblioteca_Ring {
+    struct rh_ring *r;
+    size_t largo;               // Bytes mapeados
+    BD fd;                      // Dispositivo, o -1 con el consumidor de prueba
+    // Consumidor de prueba
+    int aviso_sq, aviso_cq;     // eventfd: despertar al consumidor / al productor
+    pthread_t hilo;
+    int detener;
+    double escala;
+};
+
+static size_t largo_ring(void) {
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    return (sizeof(struct rh_ring) + pagina - 1) / pagina * pagina;
+}
+
+Biblioteca_Ring *Biblioteca_RingAbrir(BD fd) {
+    Biblioteca_Ring *ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+    ring->largo = largo_ring();
+    ring->r = mmap(NULL, ring->largo, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring->r == MAP_FAILED) {
+        perror("Biblioteca_RingAbrir");
+        free(ring);
+        return NULL;
+    }
+    ring->fd = fd;
+    ring->aviso_sq = ring->aviso_cq = -1;
+    return ring;
+}
+
+// --- Consumidor de prueba: el mismo recorrido que motor_tick en el driver ---
+static int mock_hay_trabajo(struct rh_ring *r, uint32_t sq_cabeza, uint32_t cq_cola) {
+    uint32_t pendientes = CARGAR(&r->sq_cola) - sq_cabeza;
+    return pendientes > 0 && pendientes <= RH_RING_ENTRADAS &&
+           cq_cola - CARGAR(&r->cq_cabeza) < RH_RING_ENTRADAS;
+}
+
+static void avisar_eventfd(int fd) {
+    uint64_t uno = 1;
+    if (write(fd, &uno, sizeof(uno)) != sizeof(uno)) perror("Biblioteca_Ring: eventfd");
+}
+
+static void *mock_consumidor(void *arg) {
+    Biblioteca_Ring *ring = arg;
+    struct rh_ring *r = ring->r;
+    uint32_t sq_cabeza = 0, cq_cola = 0;
+    uint64_t avisos;
+
+    while (!CARGAR(&ring->detener)) {
+        if (!mock_hay_trabajo(r, sq_cabeza, cq_cola)) {
+            // Pedir que lo despierten y volver a mirar antes de dormir
+            FIJAR(&r->sq_flags, RH_RING_DESPERTAR);
+            BARRERA();
+            if (!mock_hay_trabajo(r, sq_cabeza, cq_cola) && !CARGAR(&ring->detener)) {
+                if (read(ring->aviso_sq, &avisos, sizeof(avisos)) < 0 && errno != EINTR) break;
+            }
+            FIJAR(&r->sq_flags, 0);
+            continue;
+        }
+
+        struct rh_sqe sqe = r->sq[sq_cabeza & RING_MASCARA];
+        PUBLICAR(&r->sq_cabeza, ++sq_cabeza);
+
+        int32_t resultado = 0;
+        if (sqe.ejes == 0 || (sqe.ejes & ~RH_MASCARA_EJES)) {
+            resultado = -EINVAL;
+        } else if (ring->escala > 0) {
+            // El comando termina cuando baja su eje más largo
+            unsigned int ms_max = 0;
+            for (int e = 0; e < RH_NUM_EJES; ++e) {
+                if (!(sqe.ejes & (1u << e))) continue;
+                unsigned int ms = sqe.ms[e] ? sqe.ms[e] : MOCK_PULSO_MS;
+                if (ms > ms_max) ms_max = ms;
+            }
+            double segundos = ms_max * (sqe.repeticiones ? sqe.repeticiones : 1) * ring->escala / 1000.0;
+            struct timespec espera = { (time_t)segundos, (long)((segundos - (time_t)segundos) * 1e9) };
+            nanosleep(&espera, NULL);
+        }
+
+        struct rh_cqe *cqe = &r->cq[cq_cola & RING_MASCARA];
+        cqe->user_data = sqe.user_data;
+        cqe->resultado = resultado;
+        PUBLICAR(&r->cq_cola, ++cq_cola);
+        BARRERA();
+        uint32_t esperando = FLAGS(&r->cq_esperando);
+        if (esperando && cq_cola - CARGAR(&r->cq_cabeza) >= esperando) avisar_eventfd(ring->aviso_cq);
+    }
+    return NULL;
+}
+
+Biblioteca_Ring *Biblioteca_RingAbrirMock(double escala) {
+    Biblioteca_Ring *ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+    ring->fd = -1;
+    ring->escala = escala;
+    ring->largo = largo_ring();
+    ring->r = mmap(NULL, ring->largo, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (ring->r == MAP_FAILED) {
+        perror("Biblioteca_RingAbrirMock");
+        free(ring);
+        return NULL;
+    }
+    ring->aviso_sq = eventfd(0, 0);
+    ring->aviso_cq = eventfd(0, 0);
+    if (ring->aviso_sq < 0 || ring->aviso_cq < 0 || pthread_create(&ring->hilo, NULL, mock_consumidor, ring) != 0) {
+        perror("Biblioteca_RingAbrirMock");
+        if (ring->aviso_sq >= 0) close(ring->aviso_sq);
+        if (ring->aviso_cq >= 0) close(ring->aviso_cq);
+        munmap(ring->r, ring->largo);
+        free(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void Biblioteca_RingCerrar(Biblioteca_Ring *ring) {
+    if (!ring) return;
+    if (ring->fd < 0) {
+        PUBLICAR(&ring->detener, 1);
+        avisar_eventfd(ring->aviso_sq);
+        pthread_join(ring->hilo, NULL);
+        close(ring->aviso_sq);
+        close(ring->aviso_cq);
+    }
+    munmap(ring->r, ring->largo);
+    free(ring);
+}
+
+// Despierta al consumidor detenido (la única syscall del lado de encolar)
+static int ring_despertar(Biblioteca_Ring *ring) {
+    contadores.syscalls++;
+    if (ring->fd >= 0) return ioctl(ring->fd, RH_IOC_DESPERTAR);
+    avisar_eventfd(ring->aviso_sq);
+    return 0;
+}
+
+// Duerme hasta que haya los completados de cq_esperando (o una señal)
+static int ring_esperar(Biblioteca_Ring *ring) {
+    contadores.syscalls++;
+    if (ring->fd >= 0) {
+        struct pollfd p = { .fd = ring->fd, .events = POLLIN };
+        if (poll(&p, 1, -1) < 0 && errno != EINTR) return -1;
+        return 0;
+    }
+    uint64_t avisos;
+    if (read(ring->aviso_cq, &avisos, sizeof(avisos)) < 0 && errno != EINTR) return -1;
+    return 0;
+}
+
+int Biblioteca_RingSubmit(Biblioteca_Ring *ring, const struct rh_sqe *cmds, unsigned int n) {
+    struct rh_ring *r = ring->r;
+    uint32_t cola = r->sq_cola; // Solo la escribe este lado
+    uint32_t libres = RH_RING_ENTRADAS - (cola - CARGAR(&r->sq_cabeza));
+    if (n > libres) n = libres;
+    if (n == 0) return 0;
+
+    for (unsigned int i = 0; i < n; ++i) r->sq[(cola + i) & RING_MASCARA] = cmds[i];
+    PUBLICAR(&r->sq_cola, cola + n);
+    contadores.bytes += n * sizeof(struct rh_sqe);
+    BARRERA(); // sq_cola visible antes de mirar sq_flags (el consumidor hace lo inverso)
+    if ((FLAGS(&r->sq_flags) & RH_RING_DESPERTAR) && ring_despertar(ring) < 0) {
+        perror("Biblioteca_RingSubmit");
+        return -1;
+    }
+    return (int)n;
+}
+
+int Biblioteca_RingReap(Biblioteca_Ring *ring, struct rh_cqe *cqes, unsigned int max, unsigned int minimo) {
+    struct rh_ring *r = ring->r;
+    uint32_t cabeza = r->cq_cabeza; // Solo la escribe este lado
+    uint32_t listos;
+
+    // Cada comando encolado produce un completado: esperar más que los que faltan
+    // cosechar no terminaría nunca
+    uint32_t sin_cosechar = r->sq_cola - cabeza;
+    if (minimo > max) minimo = max;
+    if (minimo > sin_cosechar) minimo = sin_cosechar;
+    while ((listos = CARGAR(&r->cq_cola) - cabeza) < minimo) {
+        FIJAR(&r->cq_esperando, minimo);
+        BARRERA();
+        int rc = CARGAR(&r->cq_cola) - cabeza < minimo ? ring_esperar(ring) : 0;
+        FIJAR(&r->cq_esperando, 0);
+        if (rc < 0) {
+            perror("Biblioteca_RingReap");
+            return -1;
+        }
+    }
+    if (listos > max) listos = max;
+    if (listos == 0) return 0;
+
+    for (uint32_t i = 0; i < listos; ++i) cqes[i] = r->cq[(cabeza + i) & RING_MASCARA];
+    PUBLICAR(&r->cq_cabeza, cabeza + listos);
+
+    // Si el consumidor se detuvo con cq lleno y quedan comandos, ahora tiene lugar
+    BARRERA();
+    if ((FLAGS(&r->sq_flags) & RH_RING_DESPERTAR) && CARGAR(&r->sq_cabeza) != r->sq_cola &&
+        ring_despertar(ring) < 0) {
+        perror("Biblioteca_RingReap");
+        return -1;
+    }
+    return (int)listos;
+}
+
+void Biblioteca_LeerContadores(Biblioteca_Contadores *c) {
+    *c = contadores;
+}
+
+void Biblioteca_ReiniciarContadores(void) {
+    memset(&contadores, 0, sizeof(contadores));
+}
+
 int Biblioteca_Motor1_Down(BD fd) { return Biblioteca_SendCommand(fd, 'A'); }
 //int Biblioteca_Motor1_Up(BD fd)   { return Biblioteca_SendCommand(fd, '1'); }
 int Biblioteca_Motor2_Down(BD fd) { return Biblioteca_SendCommand(fd, 'T'); }
@@ -3,6 +3,8 @@
 
 #include <stddef.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include "robotic_hand_cmd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +15,14 @@ typedef int BD;
 // Abre el dispositivo y retorna descriptor, o -1 en error
 BD Biblioteca_Open(const char *device_path);
 
+// Abre la mano 'mano' (0 = RH_DISPOSITIVO, i = RH_DISPOSITIVO seguido de i). Cada mano
+// tiene su propia cola: los comandos de una no esperan a los de otra. -1 en error
+BD Biblioteca_OpenHand(int mano);
+
+// Abre (creándolo o vaciándolo) un archivo común que hace de dispositivo falso:
+// cada comando enviado queda escrito en él. Sirve para probar y medir sin hardware.
+BD Biblioteca_OpenMock(const char *file_path);
+
 // Cierra descriptor, 0 éxito o -1 en error
 int Biblioteca_Close(BD fd);
 
@@ -26,6 +36,98 @@ int Biblioteca_Motor2_Down(BD fd);  // Correspondiente a 'T'
 typedef char Cmd;
 int Biblioteca_SendCommand(BD fd, Cmd cmd);
 
+// Envía n comandos en orden con un solo write (reintenta si el driver acepta una parte).
+// 0 éxito o -1 en error
+int Biblioteca_SendCommands(BD fd, const Cmd *cmds, size_t n);
+
+// Igual, y deja en *aceptados los bytes que tomó el driver aunque falle a mitad (el
+// driver solo acepta comandos completos: es el comienzo de los que se van a ejecutar)
+int Biblioteca_SendCommandsParcial(BD fd, const Cmd *cmds, size_t n, size_t *aceptados);
+
+// Un pulso de 'ms' milisegundos en un eje (RH_EJE_*; 0 = ancho por defecto del eje):
+// un movimiento largo es un solo comando. 0 éxito o -1 en error
+int Biblioteca_Move(BD fd, unsigned int eje, unsigned short ms);
+
+// 'pasos' pulsos del ancho por defecto del eje, separados por su pausa. 0 éxito o -1 en error
+int Biblioteca_MoveSteps(BD fd, unsigned int eje, unsigned short pasos);
+
+// Movimiento simultáneo de varios ejes: 'ejes' es una máscara de bits RH_EJE_* y
+// ms[eje] la duración del pulso de cada eje de la máscara (0 = ancho por defecto).
+// Todos los ejes arrancan juntos. 0 éxito o -1 en error
+int Biblioteca_MoveAxes(BD fd, unsigned int ejes, const unsigned short ms[RH_NUM_EJES]);
+
+// Codifica el mismo comando en 'destino' (al menos RH_MAX_COMANDO bytes) para armar
+// programas. Devuelve los bytes escritos, o 0 si la máscara no es válida
+size_t Biblioteca_CodificarEjes(Cmd *destino, unsigned int ejes, const unsigned short ms[RH_NUM_EJES]);
+
+// Igual para un comando de pasos (3 bytes). 0 si el eje no es válido
+size_t Biblioteca_CodificarPasos(Cmd *destino, unsigned int eje, unsigned short pasos);
+
+// Ancho por defecto del pulso (1 a 65535 ms) y pausa mínima entre dos pulsos (0 a
+// 65535 ms) de un eje. Vale desde el próximo pulso. 0 éxito o -1 en error
+int Biblioteca_ConfigurarEje(BD fd, unsigned int eje, unsigned int pulso_ms, unsigned int pausa_ms);
+
+// Lee la configuración actual de un eje. 0 éxito o -1 en error
+int Biblioteca_LeerConfigEje(BD fd, unsigned int eje, unsigned int *pulso_ms, unsigned int *pausa_ms);
+
+// Programa de movimiento armado por tramos sin copiar los comandos: cada tramo
+// apunta al arreglo del llamador, que debe seguir vivo hasta enviarlo.
+// Todo el programa sale con un solo writev.
+#define BIBLIOTECA_MAX_TRAMOS 64
+
+typedef struct {
+    struct iovec tramos[BIBLIOTECA_MAX_TRAMOS];
+    int num_tramos;
+    size_t total;       // Comandos en el programa
+} Biblioteca_Programa;
+
+void Biblioteca_ProgramaIniciar(Biblioteca_Programa *prog);
+
+// Agrega n comandos al final del programa. 0 éxito o -1 si no quedan tramos.
+// Cada tramo debe tener comandos completos (un comando de ejes no se parte entre tramos)
+int Biblioteca_ProgramaAgregar(Biblioteca_Programa *prog, const Cmd *cmds, size_t n);
+
+// Envía el programa completo. 0 éxito o -1 en error
+int Biblioteca_ProgramaEnviar(BD fd, const Biblioteca_Programa *prog);
+
+// Anillo de comandos en memoria compartida con el driver (mmap de /dev/robotic_hand,
+// formato en robotic_hand_cmd.h). Encolar y cosechar son escrituras en memoria: solo
+// hay una syscall cuando el driver se quedó sin trabajo (hay que despertarlo) o al
+// esperar completados con el anillo vacío. Un solo hilo productor por anillo.
+typedef struct Biblioteca_Ring Biblioteca_Ring;
+
+// Mapea el anillo del dispositivo. NULL en error (p. ej. otro proceso ya lo tiene)
+Biblioteca_Ring *Biblioteca_RingAbrir(BD fd);
+
+// Anillo con un consumidor de prueba en un hilo de la biblioteca, que hace lo mismo que
+// el driver (valida, "ejecuta" y completa en orden) sin hardware. Cada comando tarda
+// su eje más largo por sus repeticiones, multiplicado por 'escala' (0 = instantáneo).
+// Usa el ancho por defecto de carga del driver y sin pausas. NULL en error
+Biblioteca_Ring *Biblioteca_RingAbrirMock(double escala);
+
+// Desmapea el anillo (y detiene el consumidor de prueba). No cierra el descriptor
+void Biblioteca_RingCerrar(Biblioteca_Ring *ring);
+
+// Encola hasta n comandos en orden. Devuelve cuántos entraron (0 si sq está lleno:
+// hay que cosechar o esperar), o -1 en error
+int Biblioteca_RingSubmit(Biblioteca_Ring *ring, const struct rh_sqe *cmds, unsigned int n);
+
+// Copia hasta max completados en orden. Si hay menos de 'minimo', duerme hasta que
+// los haya (0 = no esperar; se limita a los comandos encolados sin cosechar). El
+// driver despierta una vez por lote, no por comando.
+// Devuelve cuántos copió, o -1 en error
+int Biblioteca_RingReap(Biblioteca_Ring *ring, struct rh_cqe *cqes, unsigned int max, unsigned int minimo);
+
+// Llamadas al sistema hechas por la biblioteca para enviar comandos (write, writev
+// y los avisos/esperas del anillo), para medir el costo por movimiento
+typedef struct {
+    unsigned long syscalls;
+    unsigned long bytes;
+} Biblioteca_Contadores;
+
+void Biblioteca_LeerContadores(Biblioteca_Contadores *c);
+void Biblioteca_ReiniciarContadores(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,97 @@
+#ifndef ROBOTIC_HAND_CMD_H
+#define ROBOTIC_HAND_CMD_H
+
+// Formato de los comandos que acepta /dev/robotic_hand. Lo comparten el driver
+// (robotic_hand_driver.c) y la biblioteca, así ambos lados codifican igual.
+//
+// Cada write es una secuencia de comandos completos:
+//   * Una letra ('A', 'T', 'D', 'I', 'S', 'B'): un pulso del ancho por defecto del eje.
+//   * RH_OP_EJES | máscara (1 byte) seguido de un __le16 por cada bit de la máscara,
+//     en orden de eje: duración en ms del pulso de ese eje (0 = ancho por defecto).
+//     Todos los ejes de la máscara suben con una sola escritura a GPSET0 y cada uno
+//     baja cuando se cumple su duración; el comando siguiente empieza cuando bajó el último.
+//   * RH_OP_PASOS | eje (1 byte) seguido de un __le16 con la cantidad de pulsos: esa
+//     cantidad de pulsos del ancho por defecto, separados por la pausa del eje (0 = nada).
+// El ancho por defecto (al cargar, PULSE_MS) y la pausa mínima entre dos pulsos de un
+// mismo eje se configuran por eje con RH_IOC_SET_EJE.
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+// Cada mano es un dispositivo: la 0 es RH_DISPOSITIVO, la i es RH_DISPOSITIVO seguido de i
+// ("/dev/robotic_hand1", ...). Cuántas hay y sus GPIO los fija el parámetro pines= del módulo.
+#define RH_DISPOSITIVO "/dev/robotic_hand"
+
+// Ejes (bit de la máscara) y su letra de comando (GPIO de la mano 0 por defecto)
+#define RH_EJE_ADELANTE   0   // 'A' - GPIO 17
+#define RH_EJE_ATRAS      1   // 'T' - GPIO 18
+#define RH_EJE_DERECHA    2   // 'D' - GPIO 27
+#define RH_EJE_IZQUIERDA  3   // 'I' - GPIO 22
+#define RH_EJE_SUBIR      4   // 'S' - GPIO 23
+#define RH_EJE_BAJAR      5   // 'B' - GPIO 24
+#define RH_NUM_EJES       6
+
+#define RH_LETRAS_EJES "ATDISB" // Letra de cada eje, en orden
+
+#define RH_OP_EJES        0x80
+#define RH_MASCARA_EJES   0x3F  // Bits válidos de la máscara (uno por eje)
+#define RH_OP_PASOS       0xC0  // | eje (0 a RH_NUM_EJES - 1)
+
+// Bytes máximos de un comando (opcode + una duración por eje)
+#define RH_MAX_COMANDO    (1 + 2 * RH_NUM_EJES)
+
+// --- Anillo de comandos en memoria compartida (mmap del dispositivo) ---
+// Un productor (la biblioteca) y un consumidor (el driver): el productor llena
+// entradas de sq y avanza sq_cola; el consumidor ejecuta cada comando y deja su
+// resultado en cq. Los índices corren libres (u32) y la posición es índice & (RH_RING_ENTRADAS - 1).
+// Mientras el consumidor tenga trabajo nadie hace syscalls: solo cuando se queda sin
+// comandos marca RH_RING_DESPERTAR en sq_flags y el productor lo avisa con
+// RH_IOC_DESPERTAR. Al revés, quien espera completados anota cuántos quiere en
+// cq_esperando y duerme en poll(); el consumidor lo despierta recién cuando los hay.
+#define RH_RING_ENTRADAS  256           // Potencia de 2
+
+#define RH_RING_DESPERTAR (1u << 0)     // sq_flags: el consumidor está detenido
+
+struct rh_sqe {
+    __u64 user_data;                    // Vuelve tal cual en el completado
+    __u16 ms[RH_NUM_EJES];              // Duración de cada eje de la máscara (0 = ancho por defecto)
+    __u8  ejes;                         // Máscara de bits RH_EJE_*
+    __u8  reservado;
+    __u16 repeticiones;                 // Veces que se repite, con la pausa de los ejes (0 = una)
+};
+
+struct rh_cqe {
+    __u64 user_data;
+    __s32 resultado;                    // 0, o -EINVAL si el comando no era válido
+    __u32 reservado;
+};
+
+// Lo que escribe cada lado va en su propia línea de caché
+struct rh_ring {
+    // Escribe el consumidor
+    __u32 sq_cabeza;
+    __u32 sq_flags;
+    __u32 cq_cola;
+    __u32 relleno_consumidor[13];
+    // Escribe el productor
+    __u32 sq_cola;
+    __u32 cq_cabeza;
+    __u32 cq_esperando;                 // Completados que espera el productor dormido (0 = no duerme)
+    __u32 relleno_productor[13];
+    struct rh_sqe sq[RH_RING_ENTRADAS];
+    struct rh_cqe cq[RH_RING_ENTRADAS];
+};
+
+// --- Configuración por eje ---
+struct rh_config_eje {
+    __u32 eje;                          // RH_EJE_*
+    __u32 pulso_ms;                     // Ancho por defecto del pulso (1 a 65535)
+    __u32 pausa_ms;                     // Mínimo en bajo entre dos pulsos del eje (0 a 65535)
+};
+
+#define RH_IOC_MAGIC      'R'
+#define RH_IOC_DESPERTAR  _IO(RH_IOC_MAGIC, 1) // Reanuda el consumo del anillo
+#define RH_IOC_SET_EJE    _IOW(RH_IOC_MAGIC, 2, struct rh_config_eje)
+#define RH_IOC_GET_EJE    _IOWR(RH_IOC_MAGIC, 3, struct rh_config_eje) // Entrada: eje
+
+#endif // ROBOTIC_HAND_CMD_H
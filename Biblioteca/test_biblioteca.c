@@ -3,7 +3,7 @@
 
 int main() {
     // 1) Abrir el dispositivo que el driver expone
-    BD fd = Biblioteca_Open("/dev/robotic_hand");
+    BD fd = Biblioteca_OpenHand(0); // RH_DISPOSITIVO
     if (fd < 0) {
         return 1;
     }
@@ -23,6 +23,32 @@ int main() {
     printf("Moviendo motor2 hacia abajo (bit=T)...\n");
     Biblioteca_Motor2_Down(fd);
 
+    // Secuencia completa con un solo write
+    const Cmd secuencia[] = { 'A', 'D', 'A', 'D', 'T' };
+    printf("Enviando una secuencia de %zu comandos...\n", sizeof(secuencia));
+    if (Biblioteca_SendCommands(fd, secuencia, sizeof(secuencia)) < 0) {
+        printf("Error al enviar la secuencia\n");
+    }
+
+    // Diagonal: derecha y arriba a la vez, la subida dura el doble
+    unsigned short ms[RH_NUM_EJES] = { 0 };
+    ms[RH_EJE_DERECHA] = 200;
+    ms[RH_EJE_SUBIR] = 400;
+    printf("Moviendo en diagonal (derecha + subir)...\n");
+    if (Biblioteca_MoveAxes(fd, (1u << RH_EJE_DERECHA) | (1u << RH_EJE_SUBIR), ms) < 0) {
+        printf("Error al enviar el movimiento diagonal\n");
+    }
+
+    // Movimiento largo con un solo comando y pasos con el ancho configurado del eje
+    printf("Subiendo 1 segundo con un solo comando...\n");
+    if (Biblioteca_Move(fd, RH_EJE_SUBIR, 1000) < 0) {
+        printf("Error al enviar Move\n");
+    }
+    printf("Bajando 5 pasos de 40 ms con 20 ms de pausa...\n");
+    if (Biblioteca_ConfigurarEje(fd, RH_EJE_BAJAR, 40, 20) < 0 || Biblioteca_MoveSteps(fd, RH_EJE_BAJAR, 5) < 0) {
+        printf("Error al enviar los pasos\n");
+    }
+
     // 3) Cerrar
     Biblioteca_Close(fd);
     return 0;
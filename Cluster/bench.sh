@@ -0,0 +1,18 @@
+#!/bin/bash
+# Este script compila y ejecuta el microbenchmark de conteo de palabras sobre SAT.txt.
+
+CORPUS=${1:-SAT.txt}
+REPETICIONES=${2:-5}
+
+echo "Compilando bench_conteo.c..."
+
+# node_manager.c incluye mpi.h, por eso se compila con mpicc (no se llama a MPI_Init)
+mpicc -Wall -O2 -o bench_conteo bench_conteo.c node_manager.c word_table.c xor_cipher.c tokenizer.c space_saving.c metricas.c
+
+if [ $? -eq 0 ]; then
+    echo "¡Compilación exitosa!"
+    echo "-------------------------------------"
+    ./bench_conteo "$CORPUS" "$REPETICIONES"
+else
+    echo "¡Error de compilación!"
+fi
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "node_manager.h"
+
+// Microbenchmark: conteo con lista enlazada (implementación anterior) contra
+// la tabla hash con arena de find_most_frequent_word, sobre el mismo texto.
+
+// --- Implementación anterior, copiada tal cual como referencia ---
+typedef struct WordCount {
+    char *word;
+    int count;
+    struct WordCount *next;
+} WordCount;
+
+static void contar_lista_enlazada(const unsigned char* text, size_t len, char* most_frequent, int* max_count) {
+    WordCount *head = NULL;
+    char *text_copy = malloc(len + 1);
+    if (!text_copy) return;
+    memcpy(text_copy, text, len);
+    text_copy[len] = '\0';
+
+    const char *delimiters = " \t\n\r,.;:!?\"()[]{}";
+    char *token = strtok(text_copy, delimiters);
+
+    while (token != NULL) {
+        WordCount *current = head;
+        WordCount *found = NULL;
+        while (current != NULL) {
+            if (strcmp(current->word, token) == 0) {
+                found = current;
+                break;
+            }
+            current = current->next;
+        }
+
+        if (found) {
+            found->count++;
+        } else {
+            WordCount *newNode = malloc(sizeof(WordCount));
+            newNode->word = strdup(token);
+            newNode->count = 1;
+            newNode->next = head;
+            head = newNode;
+        }
+        token = strtok(NULL, delimiters);
+    }
+
+    *max_count = 0;
+    strcpy(most_frequent, "");
+    WordCount *current = head;
+    while (current != NULL) {
+        if (current->count > *max_count) {
+            *max_count = current->count;
+            strcpy(most_frequent, current->word);
+        }
+        WordCount *temp = current;
+        current = current->next;
+        free(temp->word);
+        free(temp);
+    }
+    free(text_copy);
+}
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+typedef void (*ContarFn)(const unsigned char*, size_t, char*, int*);
+
+// Devuelve el mejor tiempo (ms) de 'repeticiones' corridas
+static double medir(ContarFn fn, const unsigned char *texto, size_t len, int repeticiones,
+                    char *palabra, int *frecuencia) {
+    double mejor = -1;
+    for (int r = 0; r < repeticiones; ++r) {
+        double t0 = ahora_ms();
+        fn(texto, len, palabra, frecuencia);
+        double t = ahora_ms() - t0;
+        if (mejor < 0 || t < mejor) mejor = t;
+    }
+    return mejor;
+}
+
+int main(int argc, char *argv[]) {
+    const char *ruta = argc > 1 ? argv[1] : "SAT.txt";
+    int repeticiones = argc > 2 ? atoi(argv[2]) : 5;
+    if (repeticiones < 1) repeticiones = 1;
+
+    FILE *f = fopen(ruta, "rb");
+    if (!f) {
+        perror("Error: No se pudo abrir el corpus");
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long tamano = ftell(f);
+    rewind(f);
+    if (tamano < 0) {
+        perror("Error: No se pudo determinar el tamaño del corpus");
+        fclose(f);
+        return 1;
+    }
+    unsigned char *texto = malloc(tamano);
+    if (!texto || fread(texto, 1, tamano, f) != (size_t)tamano) {
+        fprintf(stderr, "Error: No se pudo leer el corpus\n");
+        fclose(f);
+        free(texto);
+        return 1;
+    }
+    fclose(f);
+
+    char palabra_lista[MAX_PALABRA], palabra_tabla[MAX_PALABRA];
+    int frec_lista = 0, frec_tabla = 0;
+
+    double t_lista = medir(contar_lista_enlazada, texto, tamano, repeticiones, palabra_lista, &frec_lista);
+    double t_tabla = medir(find_most_frequent_word, texto, tamano, repeticiones, palabra_tabla, &frec_tabla);
+
+    printf("[BENCH] Corpus '%s': %ld bytes, mejor de %d corridas\n", ruta, tamano, repeticiones);
+    printf("    lista enlazada: %9.2f ms  '%s' (%d)\n", t_lista, palabra_lista, frec_lista);
+    printf("    tabla hash    : %9.2f ms  '%s' (%d)\n", t_tabla, palabra_tabla, frec_tabla);
+    printf("    aceleración   : %9.1fx\n", t_lista / t_tabla);
+
+    free(texto);
+    if (frec_lista != frec_tabla) {
+        fprintf(stderr, "[BENCH] Error: las implementaciones no coinciden.\n");
+        return 1;
+    }
+    return 0;
+}
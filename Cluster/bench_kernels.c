@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "node_manager.h"
+#include "tokenizer.h"
+#include "xor_cipher.h"
+
+// Microbenchmarks de los caminos calientes del cluster, cada uno por separado sobre
+// el mismo corpus (p. ej. uno de generar_corpus). Una línea JSON por kernel:
+//   {"kernel", "corpus", "bytes", "segundos" (mejor corrida), "mb_s", "tokens_s",
+//    "asignaciones" (malloc/calloc/realloc por corrida), "pico_rss_kib" (del proceso)}
+// Las asignaciones se cuentan envolviendo malloc con el enlazador (ver bench_kernels.sh).
+
+// --- Contador de asignaciones (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc) ---
+static unsigned long asignaciones = 0;
+
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t t);
+void *__real_realloc(void *p, size_t n);
+
+void *__wrap_malloc(size_t n) {
+    __atomic_fetch_add(&asignaciones, 1, __ATOMIC_RELAXED);
+    return __real_malloc(n);
+}
+
+void *__wrap_calloc(size_t n, size_t t) {
+    __atomic_fetch_add(&asignaciones, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, t);
+}
+
+void *__wrap_realloc(void *p, size_t n) {
+    __atomic_fetch_add(&asignaciones, 1, __ATOMIC_RELAXED);
+    return __real_realloc(p, n);
+}
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long pico_rss_kib(void) {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+}
+
+typedef struct {
+    unsigned char *texto;
+    size_t len;
+    const char *clave;
+    XorCipher cipher;
+    Tokenizer tk;
+    unsigned long long tokens;  // Lo llena el kernel del tokenizador
+    int partes;
+} Contexto;
+
+typedef void (*KernelFn)(Contexto *ctx);
+
+// --- Kernels ---
+
+static int contar_token(void *ctx, const char *palabra, size_t len, uint64_t hash) {
+    (void)palabra; (void)len; (void)hash;
+    ++*(unsigned long long *)ctx;
+    return 0;
+}
+
+static void kernel_tokenizador(Contexto *ctx) {
+    ctx->tokens = 0;
+    tokenizar(&ctx->tk, ctx->texto, ctx->len, contar_token, &ctx->tokens);
+}
+
+static void kernel_conteo(Contexto *ctx) {
+    char palabra[MAX_PALABRA];
+    int frecuencia;
+    find_most_frequent_word(ctx->texto, ctx->len, palabra, &frecuencia);
+}
+
+static void kernel_xor(Contexto *ctx) {
+    xor_at(&ctx->cipher, ctx->texto, ctx->len, 0);
+}
+
+static void kernel_cortes(Contexto *ctx) {
+    size_t cortes[ctx->partes];
+    calcular_cortes(ctx->texto, ctx->len, ctx->clave, ctx->partes, cortes);
+}
+
+// --- Corre el kernel 'repeticiones' veces y reporta la mejor ---
+static void medir(const char *nombre, KernelFn fn, Contexto *ctx, int repeticiones, const char *corpus,
+                  unsigned long long tokens) {
+    double mejor = -1;
+    unsigned long asig = 0;
+    for (int r = 0; r < repeticiones; ++r) {
+        unsigned long antes = asignaciones;
+        double t0 = ahora_s();
+        fn(ctx);
+        double t = ahora_s() - t0;
+        asig = asignaciones - antes;
+        if (mejor < 0 || t < mejor) mejor = t;
+    }
+    if (mejor <= 0) mejor = 1e-9;
+    printf("{\"kernel\": \"%s\", \"corpus\": \"%s\", \"bytes\": %zu, \"segundos\": %.9f, "
+           "\"mb_s\": %.1f, \"tokens_s\": %.0f, \"asignaciones\": %lu, \"pico_rss_kib\": %ld}\n",
+           nombre, corpus, ctx->len, mejor, ctx->len / 1e6 / mejor,
+           tokens ? tokens / mejor : 0.0, asig, pico_rss_kib());
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <corpus> [repeticiones] [clave] [partes]\n", argv[0]);
+        return 1;
+    }
+    const char *ruta = argv[1];
+    int repeticiones = argc > 2 ? atoi(argv[2]) : 3;
+    if (repeticiones < 1) repeticiones = 1;
+
+    Contexto ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.clave = argc > 3 ? argv[3] : "clave_de_prueba";
+    ctx.partes = argc > 4 ? atoi(argv[4]) : 64;
+    if (ctx.partes < 1) ctx.partes = 1;
+
+    // El corpus se mapea (privado: el cifrado en el lugar no toca el archivo)
+    int fd = open(ruta, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        perror("Error: No se pudo abrir el corpus");
+        return 1;
+    }
+    ctx.len = st.st_size;
+    ctx.texto = mmap(NULL, ctx.len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ctx.texto == MAP_FAILED) {
+        perror("Error: No se pudo mapear el corpus");
+        return 1;
+    }
+    if (xor_cipher_init(&ctx.cipher, ctx.clave, strlen(ctx.clave)) != 0) return 1;
+    tokenizer_init(&ctx.tk, 0);
+    fprintf(stderr, "[BENCH] '%s': %zu bytes, mejor de %d corridas, cifrado %s\n",
+            ruta, ctx.len, repeticiones, xor_cipher_impl());
+
+    // Texto claro: tokenizador y conteo completo (una pasada previa cuenta los tokens
+    // y deja el corpus en memoria)
+    kernel_tokenizador(&ctx);
+    unsigned long long tokens = ctx.tokens;
+    medir("tokenizador", kernel_tokenizador, &ctx, repeticiones, ruta, tokens);
+    medir("find_most_frequent_word", kernel_conteo, &ctx, repeticiones, ruta, tokens);
+
+    // Cifrado en el lugar; cada corrida alterna claro/cifrado, así que se deja cifrado
+    medir("xor_at", kernel_xor, &ctx, repeticiones, ruta, 0);
+    if (repeticiones % 2 == 0) kernel_xor(&ctx);
+
+    // Reparto sobre el texto cifrado, como lo hace rank 0
+    medir("calcular_cortes", kernel_cortes, &ctx, repeticiones, ruta, 0);
+
+    xor_cipher_free(&ctx.cipher);
+    munmap(ctx.texto, ctx.len);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/bash
+# Este script compila los microbenchmarks de los kernels del cluster, genera los
+# corpus de referencia (SAT.txt escalado y texto Zipf) y guarda una línea JSON por
+# kernel y corpus en el archivo de resultados.
+#
+# Uso: ./bench_kernels.sh [tamaños] [repeticiones] [semilla] [resultados]
+#   ./bench_kernels.sh "1M 16M 256M" 3 1 bench_resultados.jsonl
+# Los tamaños aceptan K, M y G (hasta 10G); los corpus quedan en corpus/ para
+# comparar otras implementaciones sobre exactamente la misma entrada.
+
+TAMANOS=${1:-"1M 16M"}
+REPETICIONES=${2:-3}
+SEMILLA=${3:-1}
+RESULTADOS=${4:-bench_resultados.jsonl}
+
+echo "Compilando generar_corpus.c y bench_kernels.c..."
+
+# --wrap hace pasar malloc/calloc/realloc por el contador de asignaciones del benchmark
+gcc -Wall -O2 -o generar_corpus generar_corpus.c -lm && \
+mpicc -Wall -O2 -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -o bench_kernels \
+    bench_kernels.c node_manager.c word_table.c xor_cipher.c tokenizer.c space_saving.c metricas.c
+
+if [ $? -ne 0 ]; then
+    echo "¡Error de compilación!"
+    exit 1
+fi
+echo "¡Compilación exitosa!"
+echo "-------------------------------------"
+
+mkdir -p corpus
+for TAMANO in $TAMANOS; do
+    for TIPO in sat zipf; do
+        CORPUS="corpus/${TIPO}_${TAMANO}_s${SEMILLA}.txt"
+        # El generador es determinista: si el corpus ya existe se reutiliza
+        if [ ! -f "$CORPUS" ]; then
+            echo "Generando $CORPUS..."
+            ./generar_corpus "$TIPO" "$TAMANO" "$CORPUS" "$SEMILLA" || exit 1
+        fi
+        ./bench_kernels "$CORPUS" "$REPETICIONES" | tee -a "$RESULTADOS"
+    done
+done
+
+echo "-------------------------------------"
+echo "Resultados agregados a $RESULTADOS"
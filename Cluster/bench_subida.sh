@@ -0,0 +1,69 @@
+#!/bin/bash
+# Este script mide el throughput de subida contra un servidor local: protocolo v1 (una
+# conexión) y v2 con 1, 2, 4 y 8 flujos. Con DEMORA se agrega latencia artificial al
+# loopback con tc netem (requiere root y el módulo sch_netem), que es donde varios
+# flujos ayudan. Al final corta una subida a la mitad y muestra que se reanuda.
+#
+# Uso: ./bench_subida.sh [archivo] [demora] [puerto] [repeticiones]
+#   ./bench_subida.sh grande.txt 20ms 9099 3
+# Con demora 0 no se toca la red.
+
+ARCHIVO=${1:-SAT.txt}
+DEMORA=${2:-20ms}
+PUERTO=${3:-9099}
+REPETICIONES=${4:-3}
+CLAVE=bench_subida
+
+echo "Compilando servidor y cliente..."
+
+mpicc -Wall -O2 -I../Biblioteca -o servidor servidor.c node_manager.c word_table.c xor_cipher.c tokenizer.c space_saving.c hash_contenido.c cache_resultados.c metricas.c planificador.c ../Biblioteca/biblioteca.c -pthread -lm && \
+gcc -Wall -O2 -pthread -o cliente cliente.c xor_cipher.c hash_contenido.c
+
+if [ $? -ne 0 ]; then
+    echo "¡Error de compilación!"
+    exit 1
+fi
+echo "¡Compilación exitosa!"
+echo "-------------------------------------"
+
+if [ "$DEMORA" != "0" ]; then
+    if tc qdisc add dev lo root netem delay "$DEMORA"; then
+        echo "Loopback con $DEMORA de demora por sentido (tc netem)."
+    else
+        echo "No se pudo agregar netem (¿root? ¿sch_netem?); se mide sin demora."
+        DEMORA=0
+    fi
+fi
+
+mpirun -np 2 ./servidor "$PUERTO" "$CLAVE" --quiet > bench_subida_servidor.log 2>&1 &
+SERVIDOR=$!
+
+terminar() {
+    [ "$DEMORA" != "0" ] && tc qdisc del dev lo root 2>/dev/null
+    kill -INT "$SERVIDOR" 2>/dev/null
+    wait "$SERVIDOR" 2>/dev/null
+}
+trap terminar EXIT
+sleep 2
+
+medir() {
+    local nombre=$1
+    shift
+    for ((r = 1; r <= REPETICIONES; ++r)); do
+        # Solo la línea del throughput ("MB/s"); el resto de la salida no interesa aquí
+        local linea
+        linea=$(./cliente 127.0.0.1 "$PUERTO" "$ARCHIVO" "$CLAVE" "$@" 2>&1 | grep "MB/s")
+        printf "%-10s %s\n" "$nombre" "${linea#\[CLIENTE\] }"
+    done
+}
+
+medir "v1" --v1
+for FLUJOS in 1 2 4 8; do
+    medir "v2 x$FLUJOS" --flujos "$FLUJOS"
+done
+
+echo "-------------------------------------"
+# Con un archivo chico o sin demora la subida puede terminar antes del corte
+echo "Reanudación: se corta la subida a los 0.5 s y se vuelve a ejecutar."
+timeout -s KILL 0.5 ./cliente 127.0.0.1 "$PUERTO" "$ARCHIVO" "$CLAVE" --flujos 4 > /dev/null 2>&1
+./cliente 127.0.0.1 "$PUERTO" "$ARCHIVO" "$CLAVE" --flujos 4 2>&1 | grep -E "reanuda|MB/s|RESULTADO"
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache_resultados.h"
+
+// Formato del índice (texto, una entrada por bloque):
+//   CACHE 1
+//   E <contenido hex> <tamaño> <consulta hex> <último uso> <aproximado> <cota> <num_top>
+//   T <frecuencia> <error> <palabra>        (num_top líneas; las palabras no tienen espacios)
+
+static int misma_clave(const ClaveCache *a, const ClaveCache *b) {
+    return a->contenido == b->contenido && a->tamano == b->tamano && a->consulta == b->consulta;
+}
+
+// --- Inserta o reemplaza sin tocar el disco; desaloja la entrada menos usada si está llena ---
+static void insertar(CacheResultados *cache, const ClaveCache *clave, const ResultadoCluster *resultado,
+                     uint64_t uso) {
+    int destino = -1;
+    for (int i = 0; i < cache->usadas; ++i) {
+        if (misma_clave(&cache->entradas[i].clave, clave)) {
+            destino = i;
+            break;
+        }
+    }
+    if (destino < 0 && cache->usadas < cache->capacidad) destino = cache->usadas++;
+    if (destino < 0) {
+        destino = 0;
+        for (int i = 1; i < cache->usadas; ++i) {
+            if (cache->entradas[i].ultimo_uso < cache->entradas[destino].ultimo_uso) destino = i;
+        }
+    }
+    EntradaCache *e = &cache->entradas[destino];
+    e->clave = *clave;
+    e->ultimo_uso = uso;
+    e->resultado = *resultado;
+    e->resultado.job_id = 0;
+}
+
+static void cargar_indice(CacheResultados *cache) {
+    FILE *f = fopen(cache->ruta, "r");
+    if (!f) return;
+    char linea[MAX_PALABRA + 64];
+    if (!fgets(linea, sizeof(linea), f) || strcmp(linea, "CACHE 1\n") != 0) {
+        fprintf(stderr, "[CACHE] '%s' no es un índice válido; se ignora.\n", cache->ruta);
+        fclose(f);
+        return;
+    }
+
+    while (fgets(linea, sizeof(linea), f)) {
+        ClaveCache clave;
+        unsigned long long contenido, tamano, consulta, uso;
+        long long cota;
+        int aproximado, num_top;
+        if (sscanf(linea, "E %llx %llu %llx %llu %d %lld %d", &contenido, &tamano, &consulta, &uso,
+                   &aproximado, &cota, &num_top) != 7 || num_top < 0 || num_top > MAX_TOP) {
+            break;
+        }
+        ResultadoCluster r;
+        memset(&r, 0, sizeof(r));
+        r.aproximado = aproximado;
+        r.cota_error = cota;
+        int leidas = 0;
+        for (; leidas < num_top && fgets(linea, sizeof(linea), f); ++leidas) {
+            int desde = 0;
+            PalabraTop *t = &r.top[leidas];
+            if (sscanf(linea, "T %lld %lld %n", &t->frecuencia, &t->error, &desde) != 2 || desde == 0) break;
+            size_t len = strcspn(linea + desde, "\n");
+            if (len > MAX_PALABRA - 1) len = MAX_PALABRA - 1;
+            memcpy(t->palabra, linea + desde, len);
+            t->palabra[len] = '\0';
+        }
+        if (leidas != num_top) break;
+        r.num_top = num_top;
+        if (num_top > 0) {
+            memcpy(r.palabra, r.top[0].palabra, MAX_PALABRA);
+            r.frecuencia = r.top[0].frecuencia;
+        }
+
+        clave.contenido = contenido;
+        clave.tamano = tamano;
+        clave.consulta = consulta;
+        insertar(cache, &clave, &r, uso);
+        if (uso > cache->reloj) cache->reloj = uso;
+    }
+    fclose(f);
+    printf("[CACHE] %d resultados cargados de '%s'.\n", cache->usadas, cache->ruta);
+}
+
+static void escribir_indice(const CacheResultados *cache) {
+    char temporal[sizeof(cache->ruta) + 8];
+    snprintf(temporal, sizeof(temporal), "%s.tmp", cache->ruta);
+    FILE *f = fopen(temporal, "w");
+    if (!f) {
+        perror("[CACHE] No se pudo escribir el índice");
+        return;
+    }
+    fprintf(f, "CACHE 1\n");
+    for (int i = 0; i < cache->usadas; ++i) {
+        const EntradaCache *e = &cache->entradas[i];
+        const ResultadoCluster *r = &e->resultado;
+        fprintf(f, "E %016llx %llu %016llx %llu %d %lld %d\n",
+                (unsigned long long)e->clave.contenido, (unsigned long long)e->clave.tamano,
+                (unsigned long long)e->clave.consulta, (unsigned long long)e->ultimo_uso,
+                r->aproximado, r->cota_error, r->num_top);
+        for (int j = 0; j < r->num_top; ++j) {
+            fprintf(f, "T %lld %lld %s\n", r->top[j].frecuencia, r->top[j].error, r->top[j].palabra);
+        }
+    }
+    if (fclose(f) != 0 || rename(temporal, cache->ruta) != 0) {
+        perror("[CACHE] No se pudo reemplazar el índice");
+        remove(temporal);
+    }
+}
+
+int cache_abrir(CacheResultados *cache, const char *ruta, int capacidad) {
+    memset(cache, 0, sizeof(*cache));
+    snprintf(cache->ruta, sizeof(cache->ruta), "%s", ruta);
+    cache->capacidad = capacidad > 0 ? capacidad : 0;
+    if (cache->capacidad == 0) return 0;
+    cache->entradas = calloc(cache->capacidad, sizeof(EntradaCache));
+    if (!cache->entradas) return -1;
+    cargar_indice(cache);
+    return 0;
+}
+
+int cache_buscar(CacheResultados *cache, const ClaveCache *clave, ResultadoCluster *resultado) {
+    if (cache->capacidad == 0) return 0;
+    for (int i = 0; i < cache->usadas; ++i) {
+        EntradaCache *e = &cache->entradas[i];
+        if (!misma_clave(&e->clave, clave)) continue;
+        e->ultimo_uso = ++cache->reloj; // En memoria; llega a disco con el próximo guardado
+        *resultado = e->resultado;
+        cache->aciertos++;
+        return 1;
+    }
+    cache->fallos++;
+    return 0;
+}
+
+void cache_guardar(CacheResultados *cache, const ClaveCache *clave, const ResultadoCluster *resultado) {
+    if (cache->capacidad == 0) return;
+    insertar(cache, clave, resultado, ++cache->reloj);
+    escribir_indice(cache);
+}
+
+void cache_cerrar(CacheResultados *cache) {
+    if (cache->capacidad > 0) escribir_indice(cache); // Guarda los últimos usos
+    free(cache->entradas);
+    cache->entradas = NULL;
+    cache->usadas = cache->capacidad = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef CACHE_RESULTADOS_H
+#define CACHE_RESULTADOS_H
+
+#include <stdint.h> // Para uint64_t
+#include "node_manager.h"
+
+/**
+ * @brief Identifica un resultado: el contenido cifrado (hash XXH64 sembrado con la
+ * clave), su tamaño y la consulta con que se contó (top-k, contadores, minúsculas).
+ */
+typedef struct {
+    uint64_t contenido;
+    uint64_t tamano;
+    uint64_t consulta;
+} ClaveCache;
+
+typedef struct {
+    ClaveCache clave;
+    uint64_t ultimo_uso;        // Reloj lógico para desalojar la menos usada (LRU)
+    ResultadoCluster resultado;
+} EntradaCache;
+
+/**
+ * @brief Caché de resultados en memoria con copia en un índice de texto en disco.
+ * Guarda a lo sumo 'capacidad' entradas; al llenarse desaloja la usada hace más tiempo.
+ */
+typedef struct {
+    EntradaCache *entradas;
+    int capacidad;
+    int usadas;
+    uint64_t reloj;
+    unsigned long aciertos;
+    unsigned long fallos;
+    char ruta[256];
+} CacheResultados;
+
+/**
+ * @brief Reserva la caché y carga el índice de 'ruta' si existe.
+ * @param capacidad Máximo de entradas; 0 desactiva la caché.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int cache_abrir(CacheResultados *cache, const char *ruta, int capacidad);
+
+/**
+ * @brief Busca un resultado; cuenta un acierto o un fallo.
+ * @return 1 y copia el resultado si está, 0 si no.
+ */
+int cache_buscar(CacheResultados *cache, const ClaveCache *clave, ResultadoCluster *resultado);
+
+/**
+ * @brief Guarda un resultado (desalojando si hace falta) y reescribe el índice en disco
+ * (archivo temporal + rename, así un corte nunca deja el índice a medias).
+ */
+void cache_guardar(CacheResultados *cache, const ClaveCache *clave, const ResultadoCluster *resultado);
+
+/**
+ * @brief Libera la caché (el índice ya está en disco).
+ */
+void cache_cerrar(CacheResultados *cache);
+
+#endif // CACHE_RESULTADOS_H
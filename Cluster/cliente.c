@@ -4,54 +4,493 @@
 #include <unistd.h>     // Para close()
 #include <arpa/inet.h>  // Para inet_pton, htons, etc.
 #include <sys/socket.h> // Para socket, connect, send, recv
+#include <sys/stat.h>   // Para fstat
+#include <sys/resource.h> // Para getrusage
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "xor_cipher.h"
+#include "protocolo_v2.h"
 
-// --- INICIO DE LA LÓGICA DE CIFRADO (del paso anterior) ---
+// --- INICIO DE LA LÓGICA DE CIFRADO ---
+// El archivo nunca está entero en memoria: un hilo lee y cifra bloques en un anillo
+// de buffers mientras el hilo principal envía el bloque anterior por el socket.
 
-void xor_crypt_inplace(const char *key, unsigned char *data, size_t data_len) {
-    size_t key_len = strlen(key);
-    for (size_t i = 0; i < data_len; ++i) {
-        data[i] = data[i] ^ key[i % key_len];
+#define BLOQUE_SUBIDA (256 * 1024)  // Bytes por buffer del anillo
+#define BUFFERS_ANILLO 4
+
+typedef struct {
+    unsigned char *datos[BUFFERS_ANILLO];
+    size_t largo[BUFFERS_ANILLO];
+    int llenos;                 // Buffers cifrados que esperan ser enviados
+    int lectura, envio;         // Próximo buffer a llenar / a enviar
+    int fin;                    // 1 al terminar el archivo, -1 si hubo error de lectura
+    int cancelado;              // El envío falló: el lector deja de producir
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int fd;
+    uint64_t tamano;            // Se lee a lo sumo esto, aunque el archivo crezca
+    const XorCipher *cipher;
+} AnilloSubida;
+
+static void *leer_y_cifrar(void *arg) {
+    AnilloSubida *a = arg;
+    uint64_t offset = 0;
+    for (;;) {
+        pthread_mutex_lock(&a->mutex);
+        while (a->llenos == BUFFERS_ANILLO && !a->cancelado) pthread_cond_wait(&a->cond, &a->mutex);
+        int cancelado = a->cancelado;
+        pthread_mutex_unlock(&a->mutex);
+        if (cancelado) return NULL;
+
+        // El buffer a->lectura es solo de este hilo hasta que se publique
+        int i = a->lectura;
+        size_t n = 0;
+        size_t quiero = a->tamano - offset < BLOQUE_SUBIDA ? a->tamano - offset : BLOQUE_SUBIDA;
+        int estado = quiero == 0 ? 1 : 0;
+        while (n < quiero) {
+            ssize_t r = read(a->fd, a->datos[i] + n, quiero - n);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) { estado = -1; break; }
+            if (r == 0) { estado = 1; break; }
+            n += r;
+            if (n == quiero && offset + n == a->tamano) estado = 1;
+        }
+        xor_at(a->cipher, a->datos[i], n, offset);
+        offset += n;
+
+        pthread_mutex_lock(&a->mutex);
+        a->largo[i] = n;
+        if (n > 0) {
+            a->llenos++;
+            a->lectura = (i + 1) % BUFFERS_ANILLO;
+        }
+        if (estado != 0) a->fin = estado;
+        pthread_cond_signal(&a->cond);
+        pthread_mutex_unlock(&a->mutex);
+        if (estado != 0) return NULL;
     }
 }
 
-unsigned char* cifrar_archivo_a_memoria(const char *filepath, const char *key, size_t *output_size) {
-    FILE *file = fopen(filepath, "rb");
-    if (!file) {
-        perror("Error: No se pudo abrir el archivo de entrada");
-        return NULL;
+static int send_all(int socket, const void *buffer, size_t length) {
+    const unsigned char *ptr = (const unsigned char*) buffer;
+    while (length > 0) {
+        ssize_t i = send(socket, ptr, length, MSG_NOSIGNAL);
+        if (i < 0 && errno == EINTR) continue;
+        if (i < 1) return -1;
+        ptr += i;
+        length -= i;
     }
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
-    if (file_size < 0) {
-        perror("Error: No se pudo determinar el tamaño del archivo");
-        fclose(file);
-        return NULL;
+    return 0;
+}
+
+// --- Lee, cifra y envía el archivo por bloques; devuelve los bytes enviados o -1 ---
+static long long subir_cifrado(int fd, uint64_t tamano, const char *key, int client_socket) {
+    XorCipher cipher;
+    if (xor_cipher_init(&cipher, key, strlen(key)) != 0) {
+        fprintf(stderr, "Error: No se pudo alojar memoria para la clave\n");
+        return -1;
     }
-    unsigned char *buffer = malloc(file_size);
-    if (!buffer) {
-        fprintf(stderr, "Error: No se pudo alojar memoria para el archivo\n");
-        fclose(file);
-        return NULL;
+    AnilloSubida a = { .fd = fd, .tamano = tamano, .cipher = &cipher };
+    pthread_mutex_init(&a.mutex, NULL);
+    pthread_cond_init(&a.cond, NULL);
+    long long enviados = -1;
+    int i;
+    for (i = 0; i < BUFFERS_ANILLO; ++i) {
+        a.datos[i] = malloc(BLOQUE_SUBIDA);
+        if (!a.datos[i]) break;
+    }
+
+    pthread_t lector;
+    if (i < BUFFERS_ANILLO || pthread_create(&lector, NULL, leer_y_cifrar, &a) != 0) {
+        fprintf(stderr, "Error: No se pudo preparar el anillo de buffers\n");
+        goto liberar;
     }
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    if (bytes_read != (size_t)file_size) {
+
+    enviados = 0;
+    for (;;) {
+        pthread_mutex_lock(&a.mutex);
+        while (a.llenos == 0 && a.fin == 0) pthread_cond_wait(&a.cond, &a.mutex);
+        if (a.llenos == 0) {
+            pthread_mutex_unlock(&a.mutex);
+            break;
+        }
+        int b = a.envio;
+        pthread_mutex_unlock(&a.mutex);
+
+        if (send_all(client_socket, a.datos[b], a.largo[b]) != 0) {
+            perror("[CLIENTE] Error al enviar los datos del archivo");
+            enviados = -1;
+            break;
+        }
+        enviados += a.largo[b];
+
+        pthread_mutex_lock(&a.mutex);
+        a.envio = (b + 1) % BUFFERS_ANILLO;
+        a.llenos--;
+        pthread_cond_signal(&a.cond);
+        pthread_mutex_unlock(&a.mutex);
+    }
+
+    pthread_mutex_lock(&a.mutex);
+    a.cancelado = 1;
+    pthread_cond_signal(&a.cond);
+    pthread_mutex_unlock(&a.mutex);
+    pthread_join(lector, NULL);
+    if (a.fin < 0) {
         fprintf(stderr, "Error: Ocurrió un error al leer el archivo\n");
-        fclose(file);
-        free(buffer);
-        return NULL;
+        enviados = -1;
+    } else if (enviados >= 0 && (uint64_t)enviados != tamano) {
+        fprintf(stderr, "Error: El archivo se acortó durante el envío\n");
+        enviados = -1;
     }
-    fclose(file);
-    xor_crypt_inplace(key, buffer, bytes_read);
-    *output_size = bytes_read;
-    return buffer;
+
+liberar:
+    for (int j = 0; j < i; ++j) free(a.datos[j]);
+    pthread_mutex_destroy(&a.mutex);
+    pthread_cond_destroy(&a.cond);
+    xor_cipher_free(&cipher);
+    return enviados;
+}
+
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// --- Pico de memoria residente del proceso, en KiB ---
+static long pico_rss_kib(void) {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
 }
 // --- FIN DE LA LÓGICA DE CIFRADO ---
 
+static int recv_all(int socket, void *buffer, size_t length) {
+    unsigned char *ptr = buffer;
+    while (length > 0) {
+        ssize_t i = recv(socket, ptr, length, 0);
+        if (i < 0 && errno == EINTR) continue;
+        if (i < 1) return -1;
+        ptr += i;
+        length -= i;
+    }
+    return 0;
+}
+
+// --- Espera el resultado del cluster (el servidor cierra al terminar). 0 si llegó ---
+static int recibir_resultado(int client_socket) {
+    char respuesta[16384];
+    size_t leidos = 0;
+    ssize_t n;
+    while (leidos < sizeof(respuesta) - 1 &&
+           (n = recv(client_socket, respuesta + leidos, sizeof(respuesta) - 1 - leidos, 0)) > 0) {
+        leidos += n;
+    }
+    respuesta[leidos] = '\0';
+    if (leidos == 0) {
+        fprintf(stderr, "[CLIENTE] El servidor cerró sin enviar resultado.\n");
+        return -1;
+    }
+    printf("[CLIENTE] Respuesta del servidor: %s", respuesta);
+    return 0;
+}
+
+// --- INICIO DEL PROTOCOLO V2 ---
+// El archivo se parte en trozos que varios hilos envían a la vez, cada uno por su
+// conexión. Cada hilo mantiene hasta VENTANA_V2 trozos sin confirmar; un trozo
+// rechazado, o que estaba en vuelo cuando se cortó una conexión, vuelve a la lista
+// de pendientes. El id de la subida sale del archivo y la clave: si se corta todo,
+// volver a ejecutar el cliente reanuda desde lo que el servidor ya confirmó.
+
+#define VENTANA_V2 8
+#define REINTENTOS_V2 3     // Reconexiones por flujo antes de abandonar
+#define MAX_RECHAZOS_V2 32  // Trozos con suma incorrecta antes de abortar la subida
+#define MAX_FLUJOS_V2 64
+
+typedef struct {
+    struct sockaddr_in servidor;
+    int fd;                     // Archivo de entrada (se lee con pread)
+    uint64_t tamano;
+    uint64_t id;
+    uint32_t trozo;
+    int flujos;
+    const XorCipher *cipher;
+
+    pthread_mutex_t mutex;      // Protege lo que sigue
+    uint64_t siguiente;         // Offset del próximo trozo que nunca se envió
+    uint64_t *pendientes;       // Offsets a reenviar
+    size_t num_pendientes;
+    int rechazos;
+    int abortar;                // Error que no se arregla reconectando
+} SubidaV2;
+
+typedef struct {
+    SubidaV2 *s;
+    int flujo;
+    int sock;                   // -1 si está cerrado
+    uint64_t enviados;          // Bytes de datos confirmados por este flujo
+    pthread_t hilo;
+} FlujoV2;
+
+static uint32_t largo_trozo(const SubidaV2 *s, uint64_t offset) {
+    return s->tamano - offset < s->trozo ? (uint32_t)(s->tamano - offset) : s->trozo;
+}
+
+static int tomar_trozo(SubidaV2 *s, uint64_t *offset) {
+    int hay = 1;
+    pthread_mutex_lock(&s->mutex);
+    if (s->abortar) {
+        hay = 0;
+    } else if (s->num_pendientes > 0) {
+        *offset = s->pendientes[--s->num_pendientes];
+    } else if (s->siguiente < s->tamano) {
+        *offset = s->siguiente;
+        s->siguiente += largo_trozo(s, s->siguiente);
+    } else {
+        hay = 0;
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return hay;
+}
+
+// Entra siempre: nunca hay más trozos pendientes que en vuelo entre todos los flujos
+static void devolver_trozo(SubidaV2 *s, uint64_t offset) {
+    pthread_mutex_lock(&s->mutex);
+    s->pendientes[s->num_pendientes++] = offset;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+static void abortar_subida(SubidaV2 *s) {
+    pthread_mutex_lock(&s->mutex);
+    s->abortar = 1;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+static int enviar_trama_v2(int sock, uint8_t tipo, uint8_t flujo, uint64_t id, uint64_t valor, uint32_t largo,
+                           uint32_t suma) {
+    unsigned char buf[TRAMA_V2_BYTES];
+    TramaV2 t = { tipo, flujo, id, valor, largo, suma };
+    trama_v2_escribir(buf, &t);
+    return send_all(sock, buf, sizeof(buf));
+}
+
+// --- Lee una trama; si el servidor respondió texto (ERROR ...), lo muestra y devuelve -2 ---
+static int leer_trama_v2(int sock, TramaV2 *t) {
+    unsigned char buf[256];
+    if (recv_all(sock, buf, 4) != 0) return -1;
+    if (!trama_v2_es_magia(buf)) {
+        // El servidor manda una línea y cierra
+        size_t leidos = 4;
+        ssize_t n;
+        while (leidos < sizeof(buf) - 1 && (n = recv(sock, buf + leidos, sizeof(buf) - 1 - leidos, 0)) > 0) {
+            leidos += n;
+        }
+        buf[leidos] = '\0';
+        fprintf(stderr, "[CLIENTE] El servidor no acepta la subida: %s", (char *)buf);
+        return -2;
+    }
+    if (recv_all(sock, buf + 4, TRAMA_V2_BYTES - 4) != 0) return -1;
+    return trama_v2_leer(buf, t);
+}
+
+// --- Conecta un flujo y presenta la subida. Devuelve el socket, -1 si falló la red,
+// -2 si el servidor la rechazó. 'confirmado' recibe el prefijo que ya tiene el servidor ---
+static int abrir_flujo(SubidaV2 *s, int flujo, uint64_t *confirmado) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    TramaV2 t;
+    int rc = -1;
+    if (connect(sock, (const struct sockaddr *)&s->servidor, sizeof(s->servidor)) == 0 &&
+        enviar_trama_v2(sock, V2_HOLA, (uint8_t)flujo, s->id, s->tamano, (uint32_t)s->flujos, 0) == 0) {
+        rc = leer_trama_v2(sock, &t);
+        if (rc == 0 && (t.tipo != V2_ESTADO || t.id != s->id || t.valor > s->tamano)) rc = -1;
+    }
+    if (rc != 0) {
+        close(sock);
+        return rc;
+    }
+    if (confirmado) *confirmado = t.valor;
+    return sock;
+}
+
+static int enviar_trozo(FlujoV2 *f, unsigned char *buf, uint64_t offset) {
+    SubidaV2 *s = f->s;
+    uint32_t largo = largo_trozo(s, offset);
+    for (uint32_t n = 0; n < largo;) {
+        ssize_t r = pread(s->fd, buf + n, largo - n, (off_t)(offset + n));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            fprintf(stderr, "Error: No se pudo leer el archivo en el offset %llu\n", (unsigned long long)(offset + n));
+            abortar_subida(s);
+            return -1;
+        }
+        n += r;
+    }
+    xor_at(s->cipher, buf, largo, offset);
+    if (enviar_trama_v2(f->sock, V2_TROZO, (uint8_t)f->flujo, s->id, offset, largo, suma_trozo(buf, largo)) != 0) {
+        return -1;
+    }
+    return send_all(f->sock, buf, largo);
+}
+
+// --- Envía trozos hasta que no quede ninguno. 0 al terminar, -1 si se cortó la conexión ---
+static int bombear_flujo(FlujoV2 *f, unsigned char *buf, uint64_t en_vuelo[VENTANA_V2], int *cuantos) {
+    SubidaV2 *s = f->s;
+    int primero = 0;
+    for (;;) {
+        uint64_t offset;
+        if (*cuantos < VENTANA_V2 && tomar_trozo(s, &offset)) {
+            en_vuelo[(primero + *cuantos) % VENTANA_V2] = offset;
+            (*cuantos)++;
+            if (enviar_trozo(f, buf, offset) != 0) goto cortado;
+            continue;
+        }
+        if (*cuantos == 0) return 0;
+
+        // Ventana llena o nada más para mandar: el servidor confirma en orden
+        TramaV2 t;
+        if (leer_trama_v2(f->sock, &t) != 0) goto cortado;
+        if ((t.tipo != V2_ACK && t.tipo != V2_RECHAZO) || t.valor != en_vuelo[primero]) {
+            fprintf(stderr, "[CLIENTE] Flujo %d: confirmación inesperada.\n", f->flujo);
+            goto cortado;
+        }
+        primero = (primero + 1) % VENTANA_V2;
+        (*cuantos)--;
+        if (t.tipo == V2_ACK) {
+            f->enviados += t.largo;
+            continue;
+        }
+        devolver_trozo(s, t.valor);
+        pthread_mutex_lock(&s->mutex);
+        if (++s->rechazos > MAX_RECHAZOS_V2) s->abortar = 1;
+        pthread_mutex_unlock(&s->mutex);
+    }
+
+cortado:
+    // Lo que estaba en vuelo vuelve a la lista (ordenado desde el más viejo)
+    for (int i = 0; i < *cuantos; ++i) devolver_trozo(s, en_vuelo[(primero + i) % VENTANA_V2]);
+    *cuantos = 0;
+    return -1;
+}
+
+static void *hilo_flujo(void *arg) {
+    FlujoV2 *f = arg;
+    unsigned char *buf = malloc(f->s->trozo);
+    uint64_t en_vuelo[VENTANA_V2];
+    int cuantos = 0;
+    if (!buf) {
+        abortar_subida(f->s);
+        return NULL;
+    }
+    for (int intento = 0; intento <= REINTENTOS_V2; ++intento) {
+        if (f->sock < 0) {
+            f->sock = abrir_flujo(f->s, f->flujo, NULL);
+            if (f->sock == -2) abortar_subida(f->s);
+            if (f->sock < 0) {
+                f->sock = -1;
+                continue;
+            }
+        }
+        if (bombear_flujo(f, buf, en_vuelo, &cuantos) == 0) break;
+        fprintf(stderr, "[CLIENTE] Flujo %d cortado; reconectando (%d de %d).\n", f->flujo, intento + 1,
+                REINTENTOS_V2);
+        close(f->sock);
+        f->sock = -1;
+    }
+    free(buf);
+    return NULL;
+}
+
+// --- Id de la subida: mismo archivo (sin cambios) y misma clave, mismo id ---
+static uint64_t id_subida(const struct stat *st, const char *key) {
+    uint64_t datos[5] = { (uint64_t)st->st_dev, (uint64_t)st->st_ino, (uint64_t)st->st_size,
+                          (uint64_t)st->st_mtim.tv_sec, (uint64_t)st->st_mtim.tv_nsec };
+    HashFlujo h;
+    hash_flujo_iniciar(&h, 0);
+    hash_flujo_agregar(&h, datos, sizeof(datos));
+    hash_flujo_agregar(&h, key, strlen(key));
+    return hash_flujo_valor(&h);
+}
+
+// --- Subida v2 completa: flujos en paralelo, V2_FIN y resultado. 0 éxito, -1 error ---
+static int subir_v2(const struct sockaddr_in *servidor, int fd, const struct stat *st, const char *key, int flujos,
+                    uint32_t trozo) {
+    XorCipher cipher;
+    if (xor_cipher_init(&cipher, key, strlen(key)) != 0) {
+        fprintf(stderr, "Error: No se pudo alojar memoria para la clave\n");
+        return -1;
+    }
+    SubidaV2 s = { .servidor = *servidor, .fd = fd, .tamano = (uint64_t)st->st_size, .id = id_subida(st, key),
+                   .trozo = trozo, .flujos = flujos, .cipher = &cipher };
+    FlujoV2 f[MAX_FLUJOS_V2];
+    int ret = -1, lanzados = 0;
+    pthread_mutex_init(&s.mutex, NULL);
+    s.pendientes = malloc((size_t)flujos * VENTANA_V2 * sizeof(uint64_t));
+
+    // El flujo 0 presenta la subida y queda como conexión de control (por ella va V2_FIN)
+    uint64_t confirmado = 0;
+    int control = s.pendientes ? abrir_flujo(&s, 0, &confirmado) : -1;
+    if (control < 0) {
+        if (control == -1) perror("[CLIENTE] No se pudo abrir la subida v2");
+        goto liberar;
+    }
+    s.siguiente = confirmado - confirmado % trozo;
+    if (confirmado > 0) {
+        printf("[CLIENTE] El servidor ya tiene %llu bytes de esta subida; se reanuda desde el offset %llu.\n",
+               (unsigned long long)confirmado, (unsigned long long)s.siguiente);
+    }
+    printf("[CLIENTE] Subida v2 %016llx: %d flujos, trozos de %u bytes.\n", (unsigned long long)s.id, flujos, trozo);
+
+    double t_inicio = ahora_s();
+    for (lanzados = 0; lanzados < flujos; ++lanzados) {
+        f[lanzados] = (FlujoV2){ .s = &s, .flujo = lanzados, .sock = lanzados == 0 ? control : -1 };
+        if (pthread_create(&f[lanzados].hilo, NULL, hilo_flujo, &f[lanzados]) != 0) break;
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < lanzados; ++i) {
+        pthread_join(f[i].hilo, NULL);
+        total += f[i].enviados;
+    }
+    double segundos = ahora_s() - t_inicio;
+    control = f[0].sock;
+    for (int i = 1; i < lanzados; ++i) {
+        if (f[i].sock >= 0) close(f[i].sock); // El servidor espera estos cierres antes de procesar
+    }
+
+    printf("[CLIENTE] %.1f MB/s agregados con %d flujos (%.3f s, %llu bytes enviados), pico de RSS %ld KiB.\n",
+           segundos > 0 ? total / 1e6 / segundos : 0.0, lanzados, segundos, (unsigned long long)total, pico_rss_kib());
+    for (int i = 0; i < lanzados; ++i) {
+        printf("[CLIENTE]   flujo %d: %llu bytes\n", i, (unsigned long long)f[i].enviados);
+    }
+    int completa = lanzados == flujos && !s.abortar && s.num_pendientes == 0 && s.siguiente >= s.tamano;
+    if (!completa) {
+        fprintf(stderr, "[CLIENTE] La subida quedó incompleta; al volver a ejecutar se reanuda.\n");
+    } else {
+        if (control < 0) control = abrir_flujo(&s, 0, NULL);
+        if (control >= 0 && enviar_trama_v2(control, V2_FIN, 0, s.id, s.tamano, 0, 0) == 0) {
+            ret = recibir_resultado(control);
+        } else {
+            fprintf(stderr, "[CLIENTE] No se pudo cerrar la subida; al volver a ejecutar se reanuda.\n");
+        }
+    }
+    if (control >= 0) close(control);
+
+liberar:
+    free(s.pendientes);
+    pthread_mutex_destroy(&s.mutex);
+    xor_cipher_free(&cipher);
+    return ret;
+}
+// --- FIN DEL PROTOCOLO V2 ---
+
 
 int main(int argc, char const *argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <IP servidor> <puerto> <archivo> <clave>\n", argv[0]);
+    if (argc < 5) {
+        fprintf(stderr, "Uso: %s <IP servidor> <puerto> <archivo> <clave> [--flujos N] [--trozo BYTES] [--v1]\n",
+                argv[0]);
         return 1;
     }
 
@@ -59,17 +498,36 @@ int main(int argc, char const *argv[]) {
     int port = atoi(argv[2]);
     const char *filepath = argv[3];
     const char *key = argv[4];
+    int flujos = 4;
+    long long trozo = 1 << 20;
+    int v1 = 0; // Protocolo original: una conexión, sin reanudar (el servidor en --flujo solo habla v1)
+    for (int i = 5; i < argc; ++i) {
+        if (strcmp(argv[i], "--flujos") == 0 && i + 1 < argc) {
+            flujos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trozo") == 0 && i + 1 < argc) {
+            trozo = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--v1") == 0) {
+            v1 = 1;
+        } else {
+            fprintf(stderr, "Opción desconocida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (flujos < 1 || flujos > MAX_FLUJOS_V2 || trozo < 1 || trozo > MAX_TROZO_V2) {
+        fprintf(stderr, "Error: --flujos va de 1 a %d y --trozo de 1 a %u bytes\n", MAX_FLUJOS_V2, MAX_TROZO_V2);
+        return 1;
+    }
     
-    // --- 1. Cifrar el archivo en memoria ---
-    printf("[CLIENTE] Cifrando el archivo '%s'...\n", filepath);
-    size_t encrypted_size = 0;
-    unsigned char *encrypted_data = cifrar_archivo_a_memoria(filepath, key, &encrypted_size);
-
-    if (encrypted_data == NULL) {
-        fprintf(stderr, "[CLIENTE] Falló el cifrado del archivo.\n");
+    // --- 1. Abrir el archivo (se cifra por bloques durante el envío) ---
+    int fd = open(filepath, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror("Error: No se pudo abrir el archivo de entrada");
+        if (fd >= 0) close(fd);
         return 1;
     }
-    printf("[CLIENTE] Cifrado exitoso. Tamaño: %zu bytes.\n", encrypted_size);
+    uint64_t file_size = (uint64_t)st.st_size;
+    printf("[CLIENTE] Archivo '%s': %llu bytes.\n", filepath, (unsigned long long)file_size);
 
     // --- 2. Preparar la conexión del socket ---
     int client_socket;
@@ -79,7 +537,7 @@ int main(int argc, char const *argv[]) {
     client_socket = socket(AF_INET, SOCK_STREAM, 0);
     if (client_socket < 0) {
         perror("[CLIENTE] Error al crear el socket");
-        free(encrypted_data);
+        close(fd);
         return 1;
     }
 
@@ -91,16 +549,23 @@ int main(int argc, char const *argv[]) {
     if (inet_pton(AF_INET, server_ip, &server_addr.sin_addr) <= 0) {
         perror("[CLIENTE] Dirección IP inválida");
         close(client_socket);
-        free(encrypted_data);
+        close(fd);
         return 1;
     }
 
+    if (!v1) {
+        close(client_socket);
+        int ret = subir_v2(&server_addr, fd, &st, key, flujos, (uint32_t)trozo);
+        close(fd);
+        return ret == 0 ? 0 : 1;
+    }
+
     // --- 3. Conectar al servidor ---
     printf("[CLIENTE] Conectando a %s:%d...\n", server_ip, port);
     if (connect(client_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
         perror("[CLIENTE] Falla en la conexión");
         close(client_socket);
-        free(encrypted_data);
+        close(fd);
         return 1;
     }
     printf("[CLIENTE] Conexión establecida.\n");
@@ -108,23 +573,28 @@ int main(int argc, char const *argv[]) {
     // --- 4. Enviar los datos ---
     // Primero, enviar el tamaño del archivo para que el servidor sepa cuántos bytes esperar.
     // Se convierte a formato de red para evitar problemas de endianness.
-    uint64_t net_size = htobe64(encrypted_size); // a 64-bit network byte order
-    if (send(client_socket, &net_size, sizeof(net_size), 0) < 0) {
+    uint64_t net_size = htobe64(file_size); // a 64-bit network byte order
+    if (send_all(client_socket, &net_size, sizeof(net_size)) != 0) {
         perror("[CLIENTE] Error al enviar el tamaño del archivo");
     } else {
-        printf("[CLIENTE] Enviando %zu bytes de datos...\n", encrypted_size);
-        // Segundo, enviar los datos cifrados
-        if (send(client_socket, encrypted_data, encrypted_size, 0) < 0) {
-            perror("[CLIENTE] Error al enviar los datos del archivo");
-        } else {
-            printf("[CLIENTE] Datos enviados exitosamente.\n");
+        printf("[CLIENTE] Cifrando y enviando %llu bytes de datos...\n", (unsigned long long)file_size);
+        // Segundo, cifrar y enviar los datos bloque a bloque
+        double t_inicio = ahora_s();
+        long long enviados = subir_cifrado(fd, file_size, key, client_socket);
+        double segundos = ahora_s() - t_inicio;
+        if (enviados >= 0) {
+            printf("[CLIENTE] Datos enviados exitosamente: %.1f MB/s (%.3f s), pico de RSS %ld KiB.\n",
+                   segundos > 0 ? enviados / 1e6 / segundos : 0.0, segundos, pico_rss_kib());
+
+            // Tercero, esperar el resultado del cluster (el servidor cierra al terminar)
+            recibir_resultado(client_socket);
         }
     }
 
     // --- 5. Limpieza ---
-    printf("[CLIENTE] Liberando memoria y cerrando conexión.\n");
-    free(encrypted_data); // Liberar la memoria del buffer de cifrado
+    printf("[CLIENTE] Cerrando archivo y conexión.\n");
+    close(fd);
     close(client_socket); // Cerrar el socket
 
     return 0;
-}
\ No newline at end of file
+}
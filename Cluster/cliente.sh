@@ -2,9 +2,9 @@
 # Este script compila y luego ejecuta el programa cliente.
 
 # --- Validación de argumentos ---
-if [ "$#" -ne 4 ]; then
+if [ "$#" -lt 4 ]; then
     echo "Error: Debes proporcionar la IP del servidor, el puerto, el archivo y la clave."
-    echo "Uso: ./cliente.sh <IP_servidor> <puerto> <archivo> <clave_secreta>"
+    echo "Uso: ./cliente.sh <IP_servidor> <puerto> <archivo> <clave_secreta> [--flujos N] [--trozo BYTES] [--v1]"
     exit 1
 fi
 
@@ -13,12 +13,13 @@ IP_SERVIDOR=$1
 PUERTO=$2
 ARCHIVO=$3
 CLAVE=$4
+shift 4
 
 echo "Paso 1: Compilando cliente.c..."
 
 # --- Compilación ---
 # Compila el código fuente del cliente y crea un ejecutable llamado 'cliente'
-gcc -Wall -g -o cliente cliente.c
+gcc -Wall -g -pthread -o cliente cliente.c xor_cipher.c hash_contenido.c
 
 # --- Ejecución ---
 # Verifica si la compilación fue exitosa (código de salida 0)
@@ -28,7 +29,8 @@ if [ $? -eq 0 ]; then
     echo "Paso 2: Ejecutando cliente..."
 
     # Ejecuta el programa cliente con los argumentos pasados al script
-    ./cliente "$IP_SERVIDOR" "$PUERTO" "$ARCHIVO" "$CLAVE"
+    # (las opciones que siguen a la clave eligen el protocolo y los flujos)
+    ./cliente "$IP_SERVIDOR" "$PUERTO" "$ARCHIVO" "$CLAVE" "$@"
 else
     # Mensaje en caso de que la compilación falle
     echo "¡Error de compilación! Revisa el código."
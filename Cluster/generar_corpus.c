@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+// Generador de corpus para los benchmarks. Siempre determinista para una semilla:
+//   sat  <tamaño> <salida> [semilla] [base]   SAT.txt repetido, con las líneas de cada
+//                                              repetición barajadas según la semilla
+//   zipf <tamaño> <salida> [semilla] [vocabulario] [exponente]
+//                                              texto sintético con frecuencias Zipf
+// El tamaño acepta sufijos K, M y G (potencias de 1024). La salida se escribe por
+// bloques: generar 10 GB no necesita más memoria que generar 1 MB.
+
+#define BUFFER_SALIDA (1 << 20)
+
+// --- splitmix64: PRNG chico y reproducible en cualquier máquina ---
+static uint64_t siguiente(uint64_t *estado) {
+    uint64_t z = (*estado += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double uniforme(uint64_t *estado) {
+    return (siguiente(estado) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static unsigned long long leer_tamano(const char *texto) {
+    char *fin;
+    unsigned long long n = strtoull(texto, &fin, 10);
+    switch (*fin) {
+        case 'G': case 'g': n <<= 30; break;
+        case 'M': case 'm': n <<= 20; break;
+        case 'K': case 'k': n <<= 10; break;
+        default: break;
+    }
+    return n;
+}
+
+// --- SAT.txt escalado: se escriben líneas completas mientras entren en el tamaño ---
+static int generar_sat(FILE *salida, unsigned long long tamano, uint64_t semilla, const char *base) {
+    FILE *f = fopen(base, "rb");
+    if (!f) {
+        perror("Error: No se pudo abrir el corpus base");
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long largo = ftell(f);
+    rewind(f);
+    char *texto = malloc(largo + 1);
+    if (!texto || fread(texto, 1, largo, f) != (size_t)largo) {
+        fprintf(stderr, "Error: No se pudo leer el corpus base\n");
+        fclose(f);
+        free(texto);
+        return -1;
+    }
+    fclose(f);
+
+    // Índice de líneas (cada una incluye su '\n')
+    size_t num_lineas = 0;
+    for (long i = 0; i < largo; ++i) if (texto[i] == '\n') num_lineas++;
+    if (largo > 0 && texto[largo - 1] != '\n') num_lineas++;
+    size_t *inicio = malloc((num_lineas + 1) * sizeof(size_t));
+    size_t *orden = malloc(num_lineas * sizeof(size_t));
+    if (!inicio || !orden || num_lineas == 0) {
+        free(texto);
+        free(inicio);
+        free(orden);
+        return -1;
+    }
+    size_t n = 0;
+    inicio[n++] = 0;
+    for (long i = 0; i < largo; ++i) {
+        if (texto[i] == '\n' && (size_t)(i + 1) < (size_t)largo) inicio[n++] = i + 1;
+    }
+    inicio[num_lineas] = largo;
+
+    unsigned long long escritos = 0;
+    uint64_t estado = semilla;
+    for (;;) {
+        for (size_t i = 0; i < num_lineas; ++i) orden[i] = i;
+        for (size_t i = num_lineas - 1; i > 0; --i) { // Fisher-Yates
+            size_t j = siguiente(&estado) % (i + 1);
+            size_t t = orden[i]; orden[i] = orden[j]; orden[j] = t;
+        }
+        for (size_t i = 0; i < num_lineas; ++i) {
+            size_t l = orden[i];
+            size_t len = inicio[l + 1] - inicio[l];
+            if (escritos + len > tamano) goto fin;
+            fwrite(texto + inicio[l], 1, len, salida);
+            escritos += len;
+        }
+    }
+fin:
+    free(texto);
+    free(inicio);
+    free(orden);
+    return 0;
+}
+
+// --- Palabra del rango 'r': base 26 biyectiva sobre un alfabeto barajado ---
+// Los rangos bajos (las palabras más frecuentes) son las más cortas, como en texto real.
+static size_t palabra_de(size_t r, const char *alfabeto, char *palabra) {
+    char tmp[16];
+    size_t n = 0;
+    for (size_t x = r + 1; x > 0; x = (x - 1) / 26) tmp[n++] = alfabeto[(x - 1) % 26];
+    for (size_t i = 0; i < n; ++i) palabra[i] = tmp[n - 1 - i];
+    return n;
+}
+
+static int generar_zipf(FILE *salida, unsigned long long tamano, uint64_t semilla, size_t vocabulario,
+                        double exponente) {
+    double *acumulada = malloc(vocabulario * sizeof(double));
+    char *buffer = malloc(BUFFER_SALIDA);
+    if (!acumulada || !buffer) {
+        free(acumulada);
+        free(buffer);
+        return -1;
+    }
+    double suma = 0;
+    for (size_t r = 0; r < vocabulario; ++r) {
+        suma += 1.0 / pow((double)(r + 1), exponente);
+        acumulada[r] = suma;
+    }
+
+    uint64_t estado = semilla;
+    char alfabeto[27] = "abcdefghijklmnopqrstuvwxyz";
+    for (int i = 25; i > 0; --i) {
+        int j = siguiente(&estado) % (i + 1);
+        char t = alfabeto[i]; alfabeto[i] = alfabeto[j]; alfabeto[j] = t;
+    }
+
+    unsigned long long escritos = 0;
+    size_t usado = 0;
+    int en_linea = 0;
+    while (escritos + usado < tamano) {
+        // Búsqueda binaria del rango en la distribución acumulada
+        double u = uniforme(&estado) * suma;
+        size_t lo = 0, hi = vocabulario - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (acumulada[mid] < u) lo = mid + 1; else hi = mid;
+        }
+
+        char palabra[24];
+        size_t len = palabra_de(lo, alfabeto, palabra);
+        char separador = ++en_linea == 12 ? '\n' : (siguiente(&estado) % 16 == 0 ? ',' : ' ');
+        if (separador == '\n') en_linea = 0;
+        palabra[len++] = separador;
+        if (separador == ',') palabra[len++] = ' ';
+
+        if (escritos + usado + len > tamano) break;
+        if (usado + len > BUFFER_SALIDA) {
+            fwrite(buffer, 1, usado, salida);
+            escritos += usado;
+            usado = 0;
+        }
+        memcpy(buffer + usado, palabra, len);
+        usado += len;
+    }
+    fwrite(buffer, 1, usado, salida);
+    free(acumulada);
+    free(buffer);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4 || (strcmp(argv[1], "sat") != 0 && strcmp(argv[1], "zipf") != 0)) {
+        fprintf(stderr, "Uso: %s sat <tamaño> <salida> [semilla] [base]\n", argv[0]);
+        fprintf(stderr, "     %s zipf <tamaño> <salida> [semilla] [vocabulario] [exponente]\n", argv[0]);
+        return 1;
+    }
+    unsigned long long tamano = leer_tamano(argv[2]);
+    uint64_t semilla = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+
+    FILE *salida = fopen(argv[3], "wb");
+    if (!salida) {
+        perror("Error: No se pudo crear la salida");
+        return 1;
+    }
+    int rc;
+    if (strcmp(argv[1], "sat") == 0) {
+        rc = generar_sat(salida, tamano, semilla, argc > 5 ? argv[5] : "SAT.txt");
+    } else {
+        size_t vocabulario = argc > 5 ? strtoull(argv[5], NULL, 10) : 50000;
+        double exponente = argc > 6 ? atof(argv[6]) : 1.07;
+        rc = generar_zipf(salida, tamano, semilla, vocabulario ? vocabulario : 1, exponente);
+    }
+    if (fclose(salida) != 0) rc = -1;
+    return rc == 0 ? 0 : 1;
+}
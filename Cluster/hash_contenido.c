@@ -0,0 +1,119 @@
+#include <string.h>
+#include "hash_contenido.h"
+
+// Constantes y rondas de XXH64 (Yann Collet), versión portable
+#define P1 11400714785074694791ULL
+#define P2 14029467366897019727ULL
+#define P3 1609587929392839161ULL
+#define P4 9650029242287828579ULL
+#define P5 2870177450012600261ULL
+
+static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t leer64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v)); // Little-endian, igual que el resto del cluster
+    return v;
+}
+
+static inline uint32_t leer32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t ronda(uint64_t acc, uint64_t dato) {
+    acc += dato * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+static inline uint64_t fundir_ronda(uint64_t acc, uint64_t v) {
+    acc ^= ronda(0, v);
+    return acc * P1 + P4;
+}
+
+// --- Procesa franjas completas de 32 bytes; devuelve cuántos bytes consumió ---
+static size_t franjas(HashFlujo *h, const unsigned char *p, size_t len) {
+    size_t i = 0;
+    uint64_t v0 = h->v[0], v1 = h->v[1], v2 = h->v[2], v3 = h->v[3];
+    for (; i + 32 <= len; i += 32) {
+        v0 = ronda(v0, leer64(p + i));
+        v1 = ronda(v1, leer64(p + i + 8));
+        v2 = ronda(v2, leer64(p + i + 16));
+        v3 = ronda(v3, leer64(p + i + 24));
+    }
+    h->v[0] = v0; h->v[1] = v1; h->v[2] = v2; h->v[3] = v3;
+    return i;
+}
+
+void hash_flujo_iniciar(HashFlujo *h, uint64_t semilla) {
+    h->v[0] = semilla + P1 + P2;
+    h->v[1] = semilla + P2;
+    h->v[2] = semilla;
+    h->v[3] = semilla - P1;
+    h->total = 0;
+    h->resto_len = 0;
+    h->semilla = semilla;
+}
+
+void hash_flujo_agregar(HashFlujo *h, const void *datos, size_t len) {
+    const unsigned char *p = datos;
+    h->total += len;
+
+    // Completar la franja pendiente de la llamada anterior
+    if (h->resto_len > 0) {
+        size_t falta = 32 - h->resto_len;
+        if (len < falta) {
+            memcpy(h->resto + h->resto_len, p, len);
+            h->resto_len += len;
+            return;
+        }
+        memcpy(h->resto + h->resto_len, p, falta);
+        franjas(h, h->resto, 32);
+        p += falta;
+        len -= falta;
+        h->resto_len = 0;
+    }
+
+    size_t usados = franjas(h, p, len);
+    h->resto_len = len - usados;
+    memcpy(h->resto, p + usados, h->resto_len);
+}
+
+uint64_t hash_flujo_valor(const HashFlujo *h) {
+    uint64_t r;
+    if (h->total >= 32) {
+        r = rotl(h->v[0], 1) + rotl(h->v[1], 7) + rotl(h->v[2], 12) + rotl(h->v[3], 18);
+        for (int i = 0; i < 4; ++i) r = fundir_ronda(r, h->v[i]);
+    } else {
+        r = h->semilla + P5;
+    }
+    r += h->total;
+
+    const unsigned char *p = h->resto;
+    size_t len = h->resto_len;
+    for (; len >= 8; p += 8, len -= 8) {
+        r ^= ronda(0, leer64(p));
+        r = rotl(r, 27) * P1 + P4;
+    }
+    if (len >= 4) {
+        r ^= (uint64_t)leer32(p) * P1;
+        r = rotl(r, 23) * P2 + P3;
+        p += 4;
+        len -= 4;
+    }
+    for (; len > 0; ++p, --len) {
+        r ^= *p * P5;
+        r = rotl(r, 11) * P1;
+    }
+
+    r ^= r >> 33;
+    r *= P2;
+    r ^= r >> 29;
+    r *= P3;
+    r ^= r >> 32;
+    return r;
+}
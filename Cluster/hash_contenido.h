@@ -0,0 +1,35 @@
+#ifndef HASH_CONTENIDO_H
+#define HASH_CONTENIDO_H
+
+#include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint64_t
+
+/**
+ * @brief Estado de un hash XXH64 incremental: los datos se pueden pasar en
+ * trozos de cualquier tamaño (p. ej. lo que devuelve cada recv) y el resultado
+ * es el mismo que hashear todo junto. No es criptográfico.
+ */
+typedef struct {
+    uint64_t v[4];
+    uint64_t total;
+    unsigned char resto[32];  // Bytes que todavía no completan una franja de 32
+    size_t resto_len;
+    uint64_t semilla;
+} HashFlujo;
+
+/**
+ * @brief Empieza un hash con la semilla dada.
+ */
+void hash_flujo_iniciar(HashFlujo *h, uint64_t semilla);
+
+/**
+ * @brief Agrega len bytes al hash.
+ */
+void hash_flujo_agregar(HashFlujo *h, const void *datos, size_t len);
+
+/**
+ * @brief Devuelve el hash de todo lo agregado (no modifica el estado).
+ */
+uint64_t hash_flujo_valor(const HashFlujo *h);
+
+#endif // HASH_CONTENIDO_H
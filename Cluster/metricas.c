@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metricas.h"
+
+typedef enum { METRICA_CONTADOR, METRICA_INDICADOR, METRICA_HISTOGRAMA } TipoMetrica;
+
+typedef struct {
+    char nombre[64];
+    char etiquetas[64];
+    TipoMetrica tipo;
+    double valor;                                  // Contador o indicador
+    unsigned long long cubetas[METRICAS_CUBETAS + 1]; // Histograma: observaciones por cubeta (no acumuladas)
+    unsigned long long cuenta;
+    double suma;
+} Metrica;
+
+// Límites superiores de las cubetas (segundos): de 1 ms a 1 min
+static const double limites[METRICAS_CUBETAS] = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60
+};
+
+// Crece según haga falta: cada worker agrega sus propias series
+static Metrica *metricas = NULL;
+static int num_metricas = 0, capacidad_metricas = 0;
+static char ruta_metricas[256] = "";
+
+static const char *nombre_tipo[] = { "counter", "gauge", "histogram" };
+
+void metricas_iniciar(const char *ruta) {
+    snprintf(ruta_metricas, sizeof(ruta_metricas), "%s", ruta ? ruta : "");
+}
+
+// --- Busca la serie o la crea; NULL si no hay memoria (se avisa una sola vez) ---
+static Metrica *buscar(const char *nombre, const char *etiquetas, TipoMetrica tipo) {
+    if (!etiquetas) etiquetas = "";
+    for (int i = 0; i < num_metricas; ++i) {
+        if (strcmp(metricas[i].nombre, nombre) == 0 && strcmp(metricas[i].etiquetas, etiquetas) == 0) {
+            return &metricas[i];
+        }
+    }
+    if (num_metricas == capacidad_metricas) {
+        int capacidad = capacidad_metricas ? capacidad_metricas * 2 : METRICAS_INICIALES;
+        Metrica *nuevo = realloc(metricas, capacidad * sizeof(Metrica));
+        if (!nuevo) {
+            static int avisado = 0;
+            if (!avisado) fprintf(stderr, "[METRICAS] Sin memoria: se descartan las series nuevas.\n");
+            avisado = 1;
+            return NULL;
+        }
+        metricas = nuevo;
+        capacidad_metricas = capacidad;
+    }
+    Metrica *m = &metricas[num_metricas++];
+    memset(m, 0, sizeof(*m));
+    snprintf(m->nombre, sizeof(m->nombre), "%s", nombre);
+    snprintf(m->etiquetas, sizeof(m->etiquetas), "%s", etiquetas);
+    m->tipo = tipo;
+    return m;
+}
+
+void metricas_observar(const char *nombre, const char *etiquetas, double segundos) {
+    Metrica *m = buscar(nombre, etiquetas, METRICA_HISTOGRAMA);
+    if (!m) return;
+    int c = 0;
+    while (c < METRICAS_CUBETAS && segundos > limites[c]) c++;
+    m->cubetas[c]++;
+    m->cuenta++;
+    m->suma += segundos;
+}
+
+void metricas_sumar(const char *nombre, const char *etiquetas, double valor) {
+    Metrica *m = buscar(nombre, etiquetas, METRICA_CONTADOR);
+    if (m) m->valor += valor;
+}
+
+void metricas_fijar(const char *nombre, const char *etiquetas, double valor) {
+    Metrica *m = buscar(nombre, etiquetas, METRICA_INDICADOR);
+    if (m) m->valor = valor;
+}
+
+// --- Una serie: "nombre{etiquetas,extra}" (las llaves solo si hay alguna etiqueta) ---
+static void escribir_serie(FILE *f, const char *nombre, const char *sufijo, const char *etiquetas,
+                           const char *extra) {
+    fprintf(f, "%s%s", nombre, sufijo);
+    if (etiquetas[0] || extra) {
+        fprintf(f, "{%s%s%s}", etiquetas, etiquetas[0] && extra ? "," : "", extra ? extra : "");
+    }
+}
+
+static void escribir_metrica(FILE *f, const Metrica *m) {
+    if (m->tipo != METRICA_HISTOGRAMA) {
+        escribir_serie(f, m->nombre, "", m->etiquetas, NULL);
+        fprintf(f, " %.9g\n", m->valor);
+        return;
+    }
+    // Prometheus espera cubetas acumuladas
+    unsigned long long acumuladas = 0;
+    for (int c = 0; c <= METRICAS_CUBETAS; ++c) {
+        char le[32];
+        if (c < METRICAS_CUBETAS) {
+            snprintf(le, sizeof(le), "le=\"%g\"", limites[c]);
+        } else {
+            snprintf(le, sizeof(le), "le=\"+Inf\"");
+        }
+        acumuladas += m->cubetas[c];
+        escribir_serie(f, m->nombre, "_bucket", m->etiquetas, le);
+        fprintf(f, " %llu\n", acumuladas);
+    }
+    escribir_serie(f, m->nombre, "_sum", m->etiquetas, NULL);
+    fprintf(f, " %.9g\n", m->suma);
+    escribir_serie(f, m->nombre, "_count", m->etiquetas, NULL);
+    fprintf(f, " %llu\n", m->cuenta);
+}
+
+void metricas_escribir(void) {
+    if (ruta_metricas[0] == '\0') return;
+    char temporal[sizeof(ruta_metricas) + 8];
+    snprintf(temporal, sizeof(temporal), "%s.tmp", ruta_metricas);
+    FILE *f = fopen(temporal, "w");
+    if (!f) {
+        perror("[METRICAS] No se pudo escribir el archivo de métricas");
+        return;
+    }
+
+    // Las series de un mismo nombre van juntas, detrás de una sola línea TYPE
+    for (int i = 0; i < num_metricas; ++i) {
+        int repetida = 0;
+        for (int j = 0; j < i && !repetida; ++j) repetida = strcmp(metricas[j].nombre, metricas[i].nombre) == 0;
+        if (repetida) continue;
+        fprintf(f, "# TYPE %s %s\n", metricas[i].nombre, nombre_tipo[metricas[i].tipo]);
+        for (int j = i; j < num_metricas; ++j) {
+            if (strcmp(metricas[j].nombre, metricas[i].nombre) == 0) escribir_metrica(f, &metricas[j]);
+        }
+    }
+    if (fclose(f) != 0 || rename(temporal, ruta_metricas) != 0) {
+        perror("[METRICAS] No se pudo reemplazar el archivo de métricas");
+        remove(temporal);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+/**
+ * @brief Registro de métricas de rank 0 (tiempos por fase, contadores, indicadores),
+ * volcado en formato de texto de Prometheus a un archivo. Una métrica se identifica
+ * por su nombre y sus etiquetas ya formateadas, p. ej. ("servidor_fase_segundos",
+ * "fase=\"subida\""); la primera observación la crea. No es seguro entre hilos:
+ * en el servidor solo lo usa el hilo que habla con MPI.
+ */
+
+#define METRICAS_INICIALES 128  // Series (nombre + etiquetas) reservadas al principio; después crece
+#define METRICAS_CUBETAS 15     // Límites de los histogramas, más la cubeta +Inf
+
+/**
+ * @brief Fija el archivo donde metricas_escribir vuelca el registro.
+ * Sin ruta (o ruta vacía) el registro se sigue llenando pero no se escribe.
+ */
+void metricas_iniciar(const char *ruta);
+
+/**
+ * @brief Agrega una observación (en segundos) al histograma de latencias.
+ */
+void metricas_observar(const char *nombre, const char *etiquetas, double segundos);
+
+/**
+ * @brief Suma 'valor' a un contador (los nombres terminan en _total por convención).
+ */
+void metricas_sumar(const char *nombre, const char *etiquetas, double valor);
+
+/**
+ * @brief Fija el valor actual de un indicador (gauge).
+ */
+void metricas_fijar(const char *nombre, const char *etiquetas, double valor);
+
+/**
+ * @brief Reescribe el archivo de métricas (temporal + rename: quien lo lea nunca
+ * ve un volcado a medias).
+ */
+void metricas_escribir(void);
+
+#endif // METRICAS_H
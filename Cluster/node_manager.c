@@ -1,154 +1,1170 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
 #include <mpi.h> // Cabecera principal de OpenMPI
 #include "node_manager.h"
+#include "word_table.h"
+#include "xor_cipher.h"
+#include "tokenizer.h"
+#include "space_saving.h"
+#include "metricas.h"
 
-// --- Función de ayuda para descifrar (usada por los workers) ---
-void xor_decrypt_inplace(const char *key, unsigned char *data, size_t data_len) {
-    size_t key_len = strlen(key);
-    for (size_t i = 0; i < data_len; ++i) {
-        data[i] = data[i] ^ key[i % key_len];
+// --- Mensajes informativos del manager: --quiet los apaga (los errores siguen saliendo) ---
+static int silencioso = 0;
+
+#define INFO(...) do { if (!silencioso) printf(__VA_ARGS__); } while (0)
+
+void configurar_silencio(int silencio) {
+    silencioso = silencio;
+}
+
+// --- Tokenizador compartido: la tabla de clases se arma una vez por proceso ---
+static Tokenizer tokenizer;
+static int plegar_configurado = 0;
+static pthread_once_t tokenizer_once = PTHREAD_ONCE_INIT;
+
+static void armar_tokenizer(void) {
+    tokenizer_init(&tokenizer, plegar_configurado);
+}
+
+static const Tokenizer *obtener_tokenizer(void) {
+    pthread_once(&tokenizer_once, armar_tokenizer);
+    return &tokenizer;
+}
+
+void configurar_minusculas(int plegar) {
+    plegar_configurado = plegar;
+}
+
+// --- Busca el primer delimitador en o después de 'pos' sobre el texto CIFRADO ---
+// Se descifra solo el byte que se mira, usando el flujo de la clave en esa posición.
+// 'base' es el offset absoluto de cifrado[0] dentro del archivo.
+static size_t siguiente_delimitador(const unsigned char *cifrado, size_t len, size_t pos, uint64_t base,
+                                    const char *key, size_t key_len) {
+    const Tokenizer *tk = obtener_tokenizer();
+    size_t k = key_len ? (base + pos) % key_len : 0;
+    for (; pos < len; ++pos) {
+        unsigned char c = cifrado[pos] ^ (key_len ? (unsigned char)key[k] : 0);
+        if (tokenizer_es_delimitador(tk, c)) return pos;
+        if (key_len && ++k == key_len) k = 0;
+    }
+    return len;
+}
+
+// --- Cortes del reparto estático: 'partes' tramos de tamaño parecido, alineados a palabras ---
+// El corte nominal se mueve al siguiente delimitador para no partir palabras.
+void calcular_cortes(const unsigned char *datos_cifrados, size_t tamano, const char *clave, int partes,
+                     size_t *cortes) {
+    size_t key_len = strlen(clave);
+    size_t inicio = 0;
+    for (int i = 0; i < partes; ++i) {
+        size_t fin = tamano;
+        if (i < partes - 1) {
+            size_t nominal = tamano / partes * (i + 1);
+            if (nominal < inicio) nominal = inicio;
+            fin = siguiente_delimitador(datos_cifrados, tamano, nominal, 0, clave, key_len);
+        }
+        cortes[i] = fin;
+        inicio = fin;
     }
 }
 
-// --- Estructura para contar palabras ---
-typedef struct WordCount {
-    char *word;
-    int count;
-    struct WordCount *next;
-} WordCount;
+// --- Función de ayuda para contar las palabras de un texto en una tabla (usada por los workers) ---
+// El texto se recorre en el lugar (sin copia ni '\0'); cada palabra llega con su hash.
+static int contar_palabras(const unsigned char* text, size_t len, WordTable *table) {
+    return tokenizar_en_tabla(obtener_tokenizer(), text, len, table);
+}
+
+// --- Copia acotada de la mejor palabra de una tabla a un buffer de MAX_PALABRA ---
+static void copiar_mejor(const WordTable *table, char *palabra, int *frecuencia) {
+    const WordSlot *best = word_table_best(table);
+    *frecuencia = 0;
+    palabra[0] = '\0';
+    if (best) {
+        size_t n = best->len < MAX_PALABRA - 1 ? best->len : MAX_PALABRA - 1;
+        memcpy(palabra, best->word, n);
+        palabra[n] = '\0';
+        *frecuencia = best->count;
+    }
+}
 
 // --- Función de ayuda para encontrar la palabra más frecuente (usada por los workers) ---
-// NOTA: Esta es una implementación simple con listas enlazadas.
+// Cuenta con una tabla hash de direccionamiento abierto; las palabras viven en una arena.
 void find_most_frequent_word(const unsigned char* text, size_t len, char* most_frequent, int* max_count) {
-    WordCount *head = NULL;
-    char *text_copy = malloc(len + 1);
-    if (!text_copy) return;
-    memcpy(text_copy, text, len);
-    text_copy[len] = '\0';
-
-    const char *delimiters = " \t\n\r,.;:!?\"()[]{}";
-    char *token = strtok(text_copy, delimiters);
-
-    while (token != NULL) {
-        WordCount *current = head;
-        WordCount *found = NULL;
-        while (current != NULL) {
-            if (strcmp(current->word, token) == 0) {
-                found = current;
-                break;
+    *max_count = 0;
+    most_frequent[0] = '\0';
+
+    WordTable table;
+    if (word_table_init(&table, 1024) != 0) return;
+    contar_palabras(text, len, &table);
+    copiar_mejor(&table, most_frequent, max_count);
+    word_table_free(&table);
+}
+
+// ================================================================
+// ===== CONTEO MULTIHILO DENTRO DE UN WORKER =====================
+// ================================================================
+// Cada worker reparte su chunk entre varios hilos (cortes en delimitadores).
+// Cada hilo descifra y cuenta su parte en su propia tabla, sin locks; las
+// tablas se fusionan una sola vez al final. Solo el hilo principal llama a MPI.
+// En modo aproximado cada hilo usa un resumen Space-Saving de tamaño fijo en
+// lugar de la tabla con todo el vocabulario.
+
+#define MIN_BYTES_POR_HILO (256 * 1024)
+
+static int hilos_configurados = 0; // 0 = uno por núcleo
+
+void configurar_hilos(int hilos) {
+    hilos_configurados = hilos > 0 ? hilos : 0;
+}
+
+typedef struct {
+    int hilos;
+    WordTable *tablas;       // Modo exacto: una tabla por hilo, viven hasta contador_fusionar
+    SpaceSaving *resumenes;  // Modo aproximado: un resumen por hilo (NULL en modo exacto)
+    double seg_descifrado;   // Sumados sobre todos los hilos y todos los chunks
+    double seg_conteo;
+    uint64_t bytes;
+} ContadorParalelo;
+
+typedef struct {
+    const XorCipher *cipher;
+    unsigned char *datos;
+    size_t len;
+    uint64_t offset;
+    WordTable *tabla;
+    SpaceSaving *resumen;
+    int rc;
+    double seg_descifrado;
+    double seg_conteo;
+} TareaConteo;
+
+// Reloj de los hilos de conteo (solo el hilo principal llama a MPI, ni siquiera a MPI_Wtime)
+static double reloj_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int sumar_en_resumen(void *ctx, const char *palabra, size_t len, uint64_t hash) {
+    space_saving_add((SpaceSaving *)ctx, palabra, len, hash, 1);
+    return 0;
+}
+
+static void *hilo_conteo(void *arg) {
+    TareaConteo *t = arg;
+    double t0 = reloj_s();
+    xor_at(t->cipher, t->datos, t->len, t->offset);
+    double t1 = reloj_s();
+    if (t->resumen) {
+        t->rc = tokenizar(obtener_tokenizer(), t->datos, t->len, sumar_en_resumen, t->resumen);
+    } else {
+        t->rc = contar_palabras(t->datos, t->len, t->tabla);
+    }
+    t->seg_descifrado = t1 - t0;
+    t->seg_conteo = reloj_s() - t1;
+    return NULL;
+}
+
+// --- 'contadores' == 0: conteo exacto; si no, resúmenes de ese tamaño ---
+static int contador_iniciar(ContadorParalelo *c, int contadores) {
+    int hilos = hilos_configurados;
+    if (hilos == 0) {
+        long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+        hilos = nucleos > 0 ? (int)nucleos : 1;
+    }
+    c->tablas = NULL;
+    c->resumenes = NULL;
+    c->seg_descifrado = c->seg_conteo = 0;
+    c->bytes = 0;
+    if (contadores > 0) {
+        c->resumenes = calloc(hilos, sizeof(SpaceSaving));
+        if (!c->resumenes) return -1;
+        for (int i = 0; i < hilos; ++i) {
+            if (space_saving_init(&c->resumenes[i], contadores) != 0) {
+                for (int j = 0; j < i; ++j) space_saving_free(&c->resumenes[j]);
+                free(c->resumenes);
+                return -1;
             }
-            current = current->next;
         }
+        c->hilos = hilos;
+        return 0;
+    }
+    c->tablas = calloc(hilos, sizeof(WordTable));
+    if (!c->tablas) return -1;
+    for (int i = 0; i < hilos; ++i) {
+        if (word_table_init(&c->tablas[i], 1024) != 0) {
+            for (int j = 0; j < i; ++j) word_table_free(&c->tablas[j]);
+            free(c->tablas);
+            return -1;
+        }
+    }
+    c->hilos = hilos;
+    return 0;
+}
 
-        if (found) {
-            found->count++;
-        } else {
-            WordCount *newNode = malloc(sizeof(WordCount));
-            newNode->word = strdup(token);
-            newNode->count = 1;
-            newNode->next = head;
-            head = newNode;
+// --- Descifra y cuenta 'len' bytes cifrados que empiezan en 'offset' del archivo ---
+static int contador_procesar(ContadorParalelo *c, const XorCipher *cipher,
+                             unsigned char *datos, size_t len, uint64_t offset) {
+    int hilos = c->hilos;
+    if ((size_t)hilos > len / MIN_BYTES_POR_HILO) hilos = (int)(len / MIN_BYTES_POR_HILO);
+    if (hilos < 1) hilos = 1;
+
+    TareaConteo tareas[hilos];
+    pthread_t ids[hilos];
+    size_t inicio = 0;
+    for (int i = 0; i < hilos; ++i) {
+        size_t fin = len;
+        if (i < hilos - 1) {
+            size_t nominal = len / hilos * (i + 1);
+            if (nominal < inicio) nominal = inicio;
+            // El bloque expandido empieza con la clave, sirve para mirar el texto claro
+            fin = siguiente_delimitador(datos, len, nominal, offset,
+                                        (const char *)cipher->bloque, cipher->key_len);
         }
-        token = strtok(NULL, delimiters);
+        tareas[i] = (TareaConteo){ cipher, datos + inicio, fin - inicio, offset + inicio,
+                                   c->tablas ? &c->tablas[i] : NULL,
+                                   c->resumenes ? &c->resumenes[i] : NULL, 0, 0, 0 };
+        inicio = fin;
     }
 
-    *max_count = 0;
-    strcpy(most_frequent, "");
-    WordCount *current = head;
-    while (current != NULL) {
-        if (current->count > *max_count) {
-            *max_count = current->count;
-            strcpy(most_frequent, current->word);
+    // El hilo principal hace la primera parte; los demás hilos el resto
+    int creados = 1;
+    for (int i = 1; i < hilos; ++i, ++creados) {
+        if (pthread_create(&ids[i], NULL, hilo_conteo, &tareas[i]) != 0) break;
+    }
+    hilo_conteo(&tareas[0]);
+    for (int i = creados; i < hilos; ++i) hilo_conteo(&tareas[i]); // Si no se pudo crear el hilo
+    int rc = tareas[0].rc;
+    for (int i = 1; i < creados; ++i) {
+        pthread_join(ids[i], NULL);
+        if (tareas[i].rc != 0) rc = -1;
+    }
+    for (int i = creados; i < hilos; ++i) {
+        if (tareas[i].rc != 0) rc = -1;
+    }
+    for (int i = 0; i < hilos; ++i) {
+        c->seg_descifrado += tareas[i].seg_descifrado;
+        c->seg_conteo += tareas[i].seg_conteo;
+    }
+    c->bytes += len;
+    return rc;
+}
+
+// --- Suma todas las tablas de los hilos en 'destino' (toma la del hilo 0) ---
+static int contador_fusionar(ContadorParalelo *c, WordTable *destino) {
+    int rc = 0;
+    *destino = c->tablas[0];
+    for (int i = 1; i < c->hilos; ++i) {
+        WordTable *t = &c->tablas[i];
+        for (size_t j = 0; j < t->capacity && rc == 0; ++j) {
+            const WordSlot *s = &t->slots[j];
+            if (s->hash == 0) continue;
+            rc = word_table_add_hashed(destino, s->word, s->len, s->hash, s->count);
         }
-        WordCount *temp = current;
-        current = current->next;
-        free(temp->word);
-        free(temp);
+        word_table_free(t);
     }
-    free(text_copy);
+    free(c->tablas);
+    c->tablas = NULL;
+    return rc;
 }
 
+// --- Funde los resúmenes de los hilos en 'destino' (toma el del hilo 0) ---
+static int contador_fusionar_resumen(ContadorParalelo *c, SpaceSaving *destino) {
+    int rc = 0;
+    *destino = c->resumenes[0];
+    for (int i = 1; i < c->hilos; ++i) {
+        if (rc == 0) rc = space_saving_fundir(destino, &c->resumenes[i]);
+        space_saving_free(&c->resumenes[i]);
+    }
+    free(c->resumenes);
+    c->resumenes = NULL;
+    return rc;
+}
 
-// --- Función principal que implementa la lógica distribuida ---
-void procesar_datos_distribuidos(const unsigned char *datos_cifrados, size_t tamano_datos, const char *clave) {
-    
+// ================================================================
+// ===== MAP-REDUCE: REPARTO DE CONTEOS POR HASH ENTRE WORKERS ====
+// ================================================================
+// Cada palabra tiene un único worker "dueño" (hash % workers). Los workers
+// se intercambian sus conteos locales con MPI_Alltoallv y cada dueño suma
+// los conteos de sus palabras, así el máximo entre dueños es exacto y el
+// rank 0 nunca tiene el vocabulario completo.
+// Formato de cada registro: [hash u64][count i32][len u32][bytes de la palabra]
+
+#define REGISTRO_CABECERA (sizeof(uint64_t) + sizeof(int32_t) + sizeof(uint32_t))
+
+// Comunicador solo con los workers (rank > 0). Se crea una vez en inicializar_cluster
+// (colectivo sobre MPI_COMM_WORLD); en el manager queda MPI_COMM_NULL.
+static MPI_Comm comm_workers_global = MPI_COMM_NULL;
+
+void inicializar_cluster(void) {
     int rank, num_procs;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    // Todos los repartos dividen el trabajo entre los ranks 1..num_procs-1
+    if (num_procs < 2) {
+        fprintf(stderr, "[CLUSTER] Hacen falta al menos 2 procesos (manager y un worker): mpirun -np 2 o más.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Comm_split(MPI_COMM_WORLD, rank == 0 ? MPI_UNDEFINED : 1, rank, &comm_workers_global);
+}
+
+static MPI_Comm obtener_comm_workers(void) {
+    return comm_workers_global;
+}
+
+static size_t dueno_de(uint64_t hash, int num_workers) {
+    return (size_t)(hash % (uint64_t)num_workers);
+}
+
+// Serializa la tabla local agrupada por dueño. Devuelve el buffer (o NULL) y
+// llena conteos/desplazamientos en bytes para MPI_Alltoallv.
+static unsigned char *particionar_por_dueno(const WordTable *local, int num_workers,
+                                            int *send_counts, int *send_displs) {
+    size_t *bytes = calloc(num_workers, sizeof(size_t));
+    if (!bytes) return NULL;
+    for (size_t i = 0; i < local->capacity; ++i) {
+        const WordSlot *s = &local->slots[i];
+        if (s->hash == 0) continue;
+        bytes[dueno_de(s->hash, num_workers)] += REGISTRO_CABECERA + s->len;
+    }
+
+    size_t total = 0;
+    for (int w = 0; w < num_workers; ++w) {
+        send_displs[w] = (int)total;
+        send_counts[w] = (int)bytes[w];
+        total += bytes[w];
+    }
+
+    unsigned char *buffer = malloc(total ? total : 1);
+    if (!buffer) {
+        free(bytes);
+        return NULL;
+    }
+    // Reutilizar 'bytes' como cursor de escritura de cada dueño
+    for (int w = 0; w < num_workers; ++w) bytes[w] = send_displs[w];
+    for (size_t i = 0; i < local->capacity; ++i) {
+        const WordSlot *s = &local->slots[i];
+        if (s->hash == 0) continue;
+        unsigned char *p = buffer + bytes[dueno_de(s->hash, num_workers)];
+        int32_t count = s->count;
+        uint32_t len = s->len;
+        memcpy(p, &s->hash, sizeof(uint64_t));
+        memcpy(p + sizeof(uint64_t), &count, sizeof(int32_t));
+        memcpy(p + sizeof(uint64_t) + sizeof(int32_t), &len, sizeof(uint32_t));
+        memcpy(p + REGISTRO_CABECERA, s->word, len);
+        bytes[dueno_de(s->hash, num_workers)] += REGISTRO_CABECERA + len;
+    }
+    free(bytes);
+    return buffer;
+}
+
+// Intercambia los conteos locales y acumula en 'propias' las palabras de este worker.
+// Consume (libera) la tabla local para no tener ambas copias en memoria.
+static int shuffle_y_reducir(WordTable *local, MPI_Comm comm_workers, WordTable *propias) {
+    int num_workers;
+    MPI_Comm_size(comm_workers, &num_workers);
+
+    int *send_counts = malloc(4 * num_workers * sizeof(int));
+    if (!send_counts) return -1;
+    int *send_displs = send_counts + num_workers;
+    int *recv_counts = send_displs + num_workers;
+    int *recv_displs = recv_counts + num_workers;
+
+    unsigned char *send_buf = particionar_por_dueno(local, num_workers, send_counts, send_displs);
+    word_table_free(local);
+    if (!send_buf) {
+        free(send_counts);
+        return -1;
+    }
+
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm_workers);
+    size_t total = 0;
+    for (int w = 0; w < num_workers; ++w) {
+        recv_displs[w] = (int)total;
+        total += recv_counts[w];
+    }
+    unsigned char *recv_buf = malloc(total ? total : 1);
+    if (!recv_buf) {
+        free(send_buf);
+        free(send_counts);
+        return -1;
+    }
+    MPI_Alltoallv(send_buf, send_counts, send_displs, MPI_UNSIGNED_CHAR,
+                  recv_buf, recv_counts, recv_displs, MPI_UNSIGNED_CHAR, comm_workers);
+    free(send_buf);
+    free(send_counts);
+
+    int rc = 0;
+    size_t pos = 0;
+    while (pos + REGISTRO_CABECERA <= total) {
+        uint64_t hash;
+        int32_t count;
+        uint32_t len;
+        memcpy(&hash, recv_buf + pos, sizeof(uint64_t));
+        memcpy(&count, recv_buf + pos + sizeof(uint64_t), sizeof(int32_t));
+        memcpy(&len, recv_buf + pos + sizeof(uint64_t) + sizeof(int32_t), sizeof(uint32_t));
+        const char *word = (const char *)recv_buf + pos + REGISTRO_CABECERA;
+        if (word_table_add_hashed(propias, word, len, hash, count) != 0) {
+            rc = -1;
+            break;
+        }
+        pos += REGISTRO_CABECERA + len;
+    }
+    free(recv_buf);
+    return rc;
+}
+
+
+// ================================================================
+// ===== PROTOCOLO DE TRABAJOS ENTRE EL MANAGER Y LOS WORKERS =====
+// ================================================================
+// Los workers viven en servicio_worker() y esperan un mensaje de control
+// (MPI_Bcast de 5 enteros: tipo, modo, job_id, k y contadores de la consulta). Cada trabajo usa su propio
+// rango de tags derivado del job_id, así los mensajes punto a punto de dos
+// trabajos nunca se confunden aunque uno llegue mientras otro termina.
+
+enum { CTRL_TRABAJO = 1, CTRL_APAGAR = 2 };
+enum { MODO_REPARTO = 0, MODO_FLUJO = 1, MODO_DINAMICO = 2 };
+
+// Tipos de mensaje dentro de un trabajo
+enum {
+    TAG_RES_FRECUENCIA = 0,
+    TAG_RES_PALABRA    = 1,   // [TiemposWorker][palabras con '\0']
+    TAG_BLOQUE         = 2,   // Modo flujo: [offset u64][bytes cifrados]
+    TAG_FIN            = 3,   // Modo flujo: no hay más bloques
+    TAG_PEDIDO         = 4,   // Modo dinámico: worker libre pide trabajo [espera acumulada, double]
+    TAG_CHUNK          = 5,   // Modo dinámico: [offset u64, tamaño u64] y luego los bytes
+    TAG_RESUMEN        = 6,   // Modo aproximado: [TiemposWorker][total i64][SSContador...]
+    TAGS_POR_TRABAJO   = 7
+};
+
+#define TAG_BASE_TRABAJOS 16
+#define TRABAJOS_EN_VUELO 4096 // TAG_BASE + 4096 * 7 queda bajo el mínimo de MPI_TAG_UB (32767)
+
+// Consulta de un trabajo: top-k, exacto (contadores == 0) o con resúmenes Space-Saving
+typedef struct {
+    int k;
+    int contadores;
+} Consulta;
+
+static Consulta consulta_configurada = { 1, 0 };
+
+// Tiempos de un worker en un trabajo; viajan al manager delante del resultado.
+// descifrado y conteo suman el tiempo de todos los hilos; las otras fases son de reloj.
+enum { FASE_RECEPCION, FASE_DESCIFRADO, FASE_CONTEO, FASE_REDUCCION, FASE_TOTAL, FASES_WORKER };
+
+static const char *nombre_fase[FASES_WORKER] = { "recepcion", "descifrado", "conteo", "reduccion", "total" };
+
+typedef struct {
+    double segundos[FASES_WORKER];
+    uint64_t bytes;             // Bytes cifrados recibidos
+    double inicio;              // MPI_Wtime local al empezar el trabajo (el manager no lo usa)
+} TiemposWorker;
+
+// --- Manager: pasa los tiempos de un worker al registro de métricas ---
+static void registrar_tiempos(int worker, const TiemposWorker *t) {
+    char etiquetas[64];
+    for (int f = 0; f < FASES_WORKER; ++f) {
+        snprintf(etiquetas, sizeof(etiquetas), "fase=\"%s\"", nombre_fase[f]);
+        metricas_observar("worker_fase_segundos", etiquetas, t->segundos[f]);
+        snprintf(etiquetas, sizeof(etiquetas), "worker=\"%d\",fase=\"%s\"", worker, nombre_fase[f]);
+        metricas_fijar("worker_ultimo_trabajo_segundos", etiquetas, t->segundos[f]);
+    }
+    snprintf(etiquetas, sizeof(etiquetas), "worker=\"%d\"", worker);
+    metricas_sumar("worker_bytes_total", etiquetas, (double)t->bytes);
+    INFO("    <- Worker %d: %llu bytes; recepción %.1f ms, descifrado %.1f ms, conteo %.1f ms, "
+         "reducción %.1f ms, total %.1f ms\n", worker, (unsigned long long)t->bytes,
+         t->segundos[FASE_RECEPCION] * 1e3, t->segundos[FASE_DESCIFRADO] * 1e3,
+         t->segundos[FASE_CONTEO] * 1e3, t->segundos[FASE_REDUCCION] * 1e3, t->segundos[FASE_TOTAL] * 1e3);
+}
+
+// --- Manager: tiempo de una fase propia de rank 0 ---
+static void registrar_fase(const char *fase, double segundos) {
+    char etiquetas[48];
+    snprintf(etiquetas, sizeof(etiquetas), "fase=\"%s\"", fase);
+    metricas_observar("servidor_fase_segundos", etiquetas, segundos);
+}
+
+void configurar_top(int k, int contadores) {
+    consulta_configurada.k = k < 1 ? 1 : (k > MAX_TOP ? MAX_TOP : k);
+    consulta_configurada.contadores = contadores > 0 ? contadores : 0;
+}
+
+static uint32_t siguiente_job = 1;
+
+static int tag_de(uint32_t job, int tipo) {
+    return TAG_BASE_TRABAJOS + (int)(job % TRABAJOS_EN_VUELO) * TAGS_POR_TRABAJO + tipo;
+}
+
+// --- Manager: abre un trabajo (o apaga) en todos los workers ---
+static void anunciar(int tipo, int modo, uint32_t job, const Consulta *q) {
+    int control[5] = { tipo, modo, (int)job, q->k, q->contadores };
+    MPI_Bcast(control, 5, MPI_INT, 0, MPI_COMM_WORLD);
+}
+
+// --- Manager: envía la clave a todos los workers (una sola vez por trabajo) ---
+static void difundir_clave(const char *clave) {
+    int key_len = (int)strlen(clave);
+    MPI_Bcast(&key_len, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast((char *)clave, key_len + 1, MPI_CHAR, 0, MPI_COMM_WORLD);
+}
+
+// --- Worker: recibe la clave difundida por el manager y la expande para descifrar ---
+static void recibir_clave(int rank, XorCipher *cipher) {
+    int key_len;
+    MPI_Bcast(&key_len, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    char *clave = malloc(key_len + 1);
+    if (!clave) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para la clave.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Bcast(clave, key_len + 1, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (xor_cipher_init(cipher, clave, key_len) != 0) {
+        fprintf(stderr, "[WORKER %d] No se pudo expandir la clave.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    free(clave);
+}
+
+// 1 si (fa, a) va antes que (fb, b) en el ranking: mayor frecuencia, luego palabra menor
+static int va_antes(long long fa, const char *a, long long fb, const char *b) {
+    return fa > fb || (fa == fb && strcmp(a, b) < 0);
+}
+
+// --- Manager: modo exacto. Cada worker manda el top-k de las palabras de las que es
+// dueño; como cada palabra tiene un único dueño, el top-k de la unión es exacto ---
+static int recolectar_exacto(int num_procs, uint32_t job, int k, PalabraTop *top) {
+    int n = 0;
+    int frecuencias[MAX_TOP];
+    char mensaje[sizeof(TiemposWorker) + MAX_TOP * MAX_PALABRA];
+    for (int i = 1; i < num_procs; ++i) {
+        MPI_Status status;
+        int recibidas;
+        MPI_Recv(frecuencias, MAX_TOP, MPI_INT, i, tag_de(job, TAG_RES_FRECUENCIA), MPI_COMM_WORLD, &status);
+        MPI_Get_count(&status, MPI_INT, &recibidas);
+        MPI_Recv(mensaje, sizeof(mensaje), MPI_CHAR, i, tag_de(job, TAG_RES_PALABRA), MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        TiemposWorker tiempos;
+        memcpy(&tiempos, mensaje, sizeof(tiempos));
+        registrar_tiempos(i, &tiempos);
+
+        // Inserción ordenada en el top acumulado (k es chico)
+        const char *p = mensaje + sizeof(TiemposWorker);
+        for (int j = 0; j < recibidas; ++j, p += strlen(p) + 1) {
+            if (j == 0) INFO("    <- Resultado del Worker %d: palabra='%s', frecuencia=%d\n", i, p, frecuencias[j]);
+            int pos = n;
+            while (pos > 0 && va_antes(frecuencias[j], p, top[pos - 1].frecuencia, top[pos - 1].palabra)) pos--;
+            if (pos >= k) continue;
+            if (n < k) n++;
+            memmove(&top[pos + 1], &top[pos], (n - 1 - pos) * sizeof(PalabraTop));
+            size_t len = strnlen(p, MAX_PALABRA - 1);
+            memcpy(top[pos].palabra, p, len);
+            top[pos].palabra[len] = '\0';
+            top[pos].frecuencia = frecuencias[j];
+            top[pos].error = 0;
+        }
+    }
+    return n;
+}
+
+// --- Manager: modo aproximado. Funde los resúmenes de los workers; la cota de error
+// del resultado es la suma de las cotas: total / contadores ---
+static int recolectar_aproximado(int num_procs, uint32_t job, const Consulta *q, PalabraTop *top,
+                                 long long *cota) {
+    SpaceSaving global, recibido;
+    size_t bytes = sizeof(TiemposWorker) + sizeof(int64_t) + (size_t)q->contadores * sizeof(SSContador);
+    unsigned char *buffer = malloc(bytes);
+    if (!buffer || space_saving_init(&global, q->contadores) != 0 ||
+        space_saving_init(&recibido, q->contadores) != 0) {
+        fprintf(stderr, "[MANAGER] No se pudo alojar memoria para fundir los resúmenes.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    for (int i = 1; i < num_procs; ++i) {
+        MPI_Status status;
+        int n;
+        MPI_Recv(buffer, (int)bytes, MPI_BYTE, i, tag_de(job, TAG_RESUMEN), MPI_COMM_WORLD, &status);
+        MPI_Get_count(&status, MPI_BYTE, &n);
+        TiemposWorker tiempos;
+        memcpy(&tiempos, buffer, sizeof(tiempos));
+        registrar_tiempos(i, &tiempos);
+        const unsigned char *resumen = buffer + sizeof(TiemposWorker);
+        int64_t total;
+        memcpy(&total, resumen, sizeof(int64_t));
+        size_t contadores = (n - sizeof(TiemposWorker) - sizeof(int64_t)) / sizeof(SSContador);
+        INFO("    <- Resumen del Worker %d: %zu contadores, %lld palabras\n", i, contadores, (long long)total);
+        if (space_saving_cargar(&recibido, (const SSContador *)(resumen + sizeof(int64_t)), contadores, total) != 0 ||
+            space_saving_fundir(&global, &recibido) != 0) {
+            fprintf(stderr, "[MANAGER] No se pudo fundir el resumen del Worker %d.\n", i);
+        }
+    }
+
+    SSContador mejores[MAX_TOP];
+    int n = (int)space_saving_top(&global, mejores, q->k);
+    for (int j = 0; j < n; ++j) {
+        snprintf(top[j].palabra, MAX_PALABRA, "%s", mejores[j].palabra);
+        top[j].frecuencia = (long long)mejores[j].count;
+        top[j].error = (long long)mejores[j].error;
+    }
+    *cota = (long long)(global.total / q->contadores);
+    INFO("[MANAGER] Resúmenes fundidos: %lld palabras, cota de error %lld.\n", (long long)global.total, *cota);
+    space_saving_free(&global);
+    space_saving_free(&recibido);
+    free(buffer);
+    return n;
+}
+
+// --- Manager: junta los resultados de los workers según la consulta del trabajo ---
+static void recolectar_resultados(int num_procs, uint32_t job, const Consulta *q, ResultadoCluster *resultado) {
+    ResultadoCluster r;
+    memset(&r, 0, sizeof(r));
+
+    INFO("[MANAGER] Esperando resultados de los workers...\n");
+    double t0 = MPI_Wtime();
+    if (q->contadores > 0) {
+        r.aproximado = 1;
+        r.num_top = recolectar_aproximado(num_procs, job, q, r.top, &r.cota_error);
+    } else {
+        r.num_top = recolectar_exacto(num_procs, job, q->k, r.top);
+    }
+    if (r.num_top > 0) {
+        memcpy(r.palabra, r.top[0].palabra, MAX_PALABRA);
+        r.frecuencia = r.top[0].frecuencia;
+    }
+    r.job_id = job;
+    registrar_fase("recoleccion", MPI_Wtime() - t0);
+
+    INFO("[MANAGER] Trabajo %u finalizado. Palabra más repetida: '%s' (%lld veces).\n", job, r.palabra, r.frecuencia);
+    for (int j = 1; j < r.num_top; ++j) {
+        INFO("    %2d. '%s' (%lld veces%s)\n", j + 1, r.top[j].palabra, r.top[j].frecuencia,
+               r.aproximado ? ", aprox." : "");
+    }
+
+    if (resultado) *resultado = r;
+}
+
+// --- Worker: modo exacto. Shuffle + reduce de la tabla local y envío del top-k propio ---
+static void reducir_y_reportar(int rank, uint32_t job, int k, WordTable *local, MPI_Comm comm_workers,
+                               TiemposWorker *tiempos, double t_reduccion) {
+    WordTable propias;
+    if (word_table_init(&propias, 1024) != 0 ||
+        shuffle_y_reducir(local, comm_workers, &propias) != 0) {
+        fprintf(stderr, "[WORKER %d] Falló el intercambio de conteos.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    const WordSlot *mejores[MAX_TOP];
+    int frecuencias[MAX_TOP];
+    char mensaje[sizeof(TiemposWorker) + MAX_TOP * MAX_PALABRA];
+    char *palabras = mensaje + sizeof(TiemposWorker);
+    size_t n = word_table_top(&propias, mejores, k);
+    size_t usado = 0;
+    for (size_t j = 0; j < n; ++j) {
+        size_t len = mejores[j]->len < MAX_PALABRA - 1 ? mejores[j]->len : MAX_PALABRA - 1;
+        memcpy(palabras + usado, mejores[j]->word, len);
+        palabras[usado + len] = '\0';
+        usado += len + 1;
+        frecuencias[j] = mejores[j]->count;
+    }
+
+    double ahora = MPI_Wtime();
+    tiempos->segundos[FASE_REDUCCION] = ahora - t_reduccion;
+    tiempos->segundos[FASE_TOTAL] = ahora - tiempos->inicio;
+    memcpy(mensaje, tiempos, sizeof(TiemposWorker));
+
+    MPI_Send(frecuencias, (int)n, MPI_INT, 0, tag_de(job, TAG_RES_FRECUENCIA), MPI_COMM_WORLD);
+    MPI_Send(mensaje, (int)(sizeof(TiemposWorker) + usado), MPI_CHAR, 0, tag_de(job, TAG_RES_PALABRA), MPI_COMM_WORLD);
+    word_table_free(&propias);
+}
+
+// --- Worker: modo aproximado. Sin shuffle: el resumen (memoria fija) va directo al manager ---
+static void reportar_resumen(int rank, uint32_t job, SpaceSaving *resumen, TiemposWorker *tiempos,
+                             double t_reduccion) {
+    size_t bytes = sizeof(TiemposWorker) + sizeof(int64_t) + resumen->usados * sizeof(SSContador);
+    unsigned char *buffer = malloc(bytes);
+    if (!buffer) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el resumen.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    double ahora = MPI_Wtime();
+    tiempos->segundos[FASE_REDUCCION] = ahora - t_reduccion;
+    tiempos->segundos[FASE_TOTAL] = ahora - tiempos->inicio;
+    memcpy(buffer, tiempos, sizeof(TiemposWorker));
+    memcpy(buffer + sizeof(TiemposWorker), &resumen->total, sizeof(int64_t));
+    memcpy(buffer + sizeof(TiemposWorker) + sizeof(int64_t), resumen->heap, resumen->usados * sizeof(SSContador));
+    MPI_Send(buffer, (int)bytes, MPI_BYTE, 0, tag_de(job, TAG_RESUMEN), MPI_COMM_WORLD);
+    free(buffer);
+    space_saving_free(resumen);
+}
+
+// --- Worker: cierra el conteo local del trabajo y reporta según la consulta ---
+static void terminar_conteo(int rank, uint32_t job, const Consulta *q, ContadorParalelo *contador,
+                            MPI_Comm comm_workers, TiemposWorker *tiempos) {
+    tiempos->segundos[FASE_DESCIFRADO] = contador->seg_descifrado;
+    tiempos->segundos[FASE_CONTEO] = contador->seg_conteo;
+    tiempos->bytes = contador->bytes;
+    double t_reduccion = MPI_Wtime();
+    if (q->contadores > 0) {
+        SpaceSaving resumen;
+        if (contador_fusionar_resumen(contador, &resumen) != 0) {
+            fprintf(stderr, "[WORKER %d] Resumen local incompleto por falta de memoria.\n", rank);
+        }
+        reportar_resumen(rank, job, &resumen, tiempos, t_reduccion);
+        return;
+    }
+    WordTable local;
+    if (contador_fusionar(contador, &local) != 0) {
+        fprintf(stderr, "[WORKER %d] Conteo local incompleto por falta de memoria.\n", rank);
+    }
+    reducir_y_reportar(rank, job, q->k, &local, comm_workers, tiempos, t_reduccion);
+}
+
+
+// ================================================================
+// ===== MODO DINÁMICO: LOS WORKERS PIDEN CHUNKS CUANDO QUEDAN LIBRES
+// ================================================================
+// Autoplanificación guiada: cada pedido recibe restante / (2 * workers) bytes,
+// acotado entre CHUNK_DINAMICO_MIN y CHUNK_DINAMICO_MAX. Los chunks grandes del
+// principio amortizan los mensajes; los chiquitos del final emparejan a los nodos
+// lentos con los rápidos. Un chunk de tamaño 0 le dice al worker que terminó.
+
+#define CHUNK_DINAMICO_MIN (256 * 1024)
+#define CHUNK_DINAMICO_MAX (64 * 1024 * 1024)
+
+static int reparto_dinamico = 0;
+
+void configurar_reparto_dinamico(int dinamico) {
+    reparto_dinamico = dinamico;
+}
+
+static size_t tamano_guiado(size_t restante, int num_workers) {
+    size_t t = restante / (2 * (size_t)num_workers);
+    if (t < CHUNK_DINAMICO_MIN) t = CHUNK_DINAMICO_MIN;
+    if (t > CHUNK_DINAMICO_MAX) t = CHUNK_DINAMICO_MAX;
+    return t < restante ? t : restante;
+}
+
+static void repartir_dinamico(const unsigned char *datos_cifrados, size_t tamano_datos, const char *clave,
+                              int num_procs, uint32_t job) {
+    size_t key_len = strlen(clave);
+    int num_workers = num_procs - 1;
+    int *chunks = calloc(num_procs, sizeof(int));
+    uint64_t *bytes = calloc(num_procs, sizeof(uint64_t));
+    double *espera = calloc(num_procs, sizeof(double));
+    if (!chunks || !bytes || !espera) {
+        fprintf(stderr, "[MANAGER] No se pudo alojar memoria para el reparto dinámico.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    double t0 = MPI_Wtime();
+    size_t inicio = 0;
+    int activos = num_workers;
+    while (activos > 0) {
+        // El pedido trae el tiempo que el worker lleva esperando chunks
+        double espera_worker;
+        MPI_Status status;
+        MPI_Recv(&espera_worker, 1, MPI_DOUBLE, MPI_ANY_SOURCE, tag_de(job, TAG_PEDIDO), MPI_COMM_WORLD, &status);
+        int w = status.MPI_SOURCE;
+        espera[w] = espera_worker;
+
+        uint64_t chunk[2] = { inicio, 0 };
+        if (inicio < tamano_datos) {
+            size_t fin = inicio + tamano_guiado(tamano_datos - inicio, num_workers);
+            fin = siguiente_delimitador(datos_cifrados, tamano_datos, fin, 0, clave, key_len);
+            chunk[1] = fin - inicio;
+            inicio = fin;
+        }
+        MPI_Send(chunk, 2, MPI_UINT64_T, w, tag_de(job, TAG_CHUNK), MPI_COMM_WORLD);
+        if (chunk[1] == 0) {
+            activos--;
+            continue;
+        }
+        MPI_Send(datos_cifrados + chunk[0], (int)chunk[1], MPI_UNSIGNED_CHAR, w, tag_de(job, TAG_CHUNK), MPI_COMM_WORLD);
+        chunks[w]++;
+        bytes[w] += chunk[1];
+    }
+
+    registrar_fase("reparto", MPI_Wtime() - t0);
+
+    INFO("[MANAGER] Reparto dinámico del trabajo %u:\n", job);
+    for (int i = 1; i < num_procs; ++i) {
+        INFO("    Worker %d: %d chunks, %llu bytes, %.1f ms esperando chunks\n",
+               i, chunks[i], (unsigned long long)bytes[i], espera[i] * 1e3);
+    }
+    free(chunks);
+    free(bytes);
+    free(espera);
+}
+
+static void worker_dinamico(int rank, uint32_t job, const Consulta *q, TiemposWorker *tiempos) {
+    MPI_Comm comm_workers = obtener_comm_workers();
+    XorCipher cipher;
+    recibir_clave(rank, &cipher);
+
+    ContadorParalelo contador;
+    size_t capacidad = CHUNK_DINAMICO_MIN;
+    unsigned char *chunk_cifrado = malloc(capacidad);
+    if (!chunk_cifrado || contador_iniciar(&contador, q->contadores) != 0) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el reparto dinámico.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    double espera = 0;
+    for (;;) {
+        // Tiempo ocioso: desde que pide hasta que tiene el chunk en memoria
+        double t_pedido = MPI_Wtime();
+        MPI_Send(&espera, 1, MPI_DOUBLE, 0, tag_de(job, TAG_PEDIDO), MPI_COMM_WORLD);
+        uint64_t chunk[2];
+        MPI_Recv(chunk, 2, MPI_UINT64_T, 0, tag_de(job, TAG_CHUNK), MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (chunk[1] == 0) break;
+
+        if (chunk[1] > capacidad) {
+            unsigned char *mas = realloc(chunk_cifrado, chunk[1]);
+            if (!mas) {
+                fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el chunk.\n", rank);
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+            chunk_cifrado = mas;
+            capacidad = chunk[1];
+        }
+        MPI_Recv(chunk_cifrado, (int)chunk[1], MPI_UNSIGNED_CHAR, 0, tag_de(job, TAG_CHUNK), MPI_COMM_WORLD,
+                 MPI_STATUS_IGNORE);
+        espera += MPI_Wtime() - t_pedido;
+
+        if (contador_procesar(&contador, &cipher, chunk_cifrado, chunk[1], chunk[0]) != 0) {
+            fprintf(stderr, "[WORKER %d] Conteo local incompleto por falta de memoria.\n", rank);
+        }
+    }
+    free(chunk_cifrado);
+    xor_cipher_free(&cipher);
+
+    tiempos->segundos[FASE_RECEPCION] = espera;
+    terminar_conteo(rank, job, q, &contador, comm_workers, tiempos);
+}
+
+// --- Función principal que implementa la lógica distribuida ---
+// (Solo rank 0; los workers atienden el trabajo desde servicio_worker)
+void procesar_datos_distribuidos(const unsigned char *datos_cifrados, size_t tamano_datos, const char *clave,
+                                 ResultadoCluster *resultado) {
+    
+    int num_procs;
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
 
     // ================================================================
     // ===== LÓGICA DEL MANAGER (SERVIDOR, RANK 0) ====================
     // ================================================================
-    if (rank == 0) {
-        printf("[MANAGER] Distribuyendo trabajo a %d workers...\n", num_procs - 1);
-        
-        size_t tamano_base = tamano_datos / (num_procs - 1);
-        size_t tamano_extra = tamano_datos % (num_procs - 1);
-        size_t offset_actual = 0;
-        size_t key_len = strlen(clave) + 1;
+    uint32_t job = siguiente_job++;
+    Consulta q = consulta_configurada;
 
+    // Cortes del reparto estático, alineados a palabras (calcular_cortes). MPI_Scatterv
+    // usa int para conteos y desplazamientos: si un chunk o su offset no entra, el
+    // trabajo va por el reparto dinámico, cuyos chunks no pasan de CHUNK_DINAMICO_MAX.
+    double t0 = MPI_Wtime();
+    size_t *cortes = NULL;
+    int dinamico = reparto_dinamico;
+    if (!dinamico) {
+        cortes = calloc(num_procs, sizeof(size_t));
+        if (!cortes) {
+            fprintf(stderr, "[MANAGER] No se pudo alojar memoria para el reparto.\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        calcular_cortes(datos_cifrados, tamano_datos, clave, num_procs - 1, cortes);
+        size_t inicio = 0;
         for (int i = 1; i < num_procs; ++i) {
-            size_t tamano_chunk = tamano_base + (i - 1 < tamano_extra ? 1 : 0);
-            
-            printf("    -> Enviando %zu bytes al Worker %d\n", tamano_chunk, i);
-            MPI_Send(&tamano_chunk, 1, MPI_UNSIGNED_LONG, i, 0, MPI_COMM_WORLD);
-            MPI_Send(datos_cifrados + offset_actual, tamano_chunk, MPI_UNSIGNED_CHAR, i, 1, MPI_COMM_WORLD);
-            MPI_Send(clave, key_len, MPI_CHAR, i, 2, MPI_COMM_WORLD);
-            
-            offset_actual += tamano_chunk;
+            if (cortes[i - 1] - inicio > INT_MAX || inicio > INT_MAX) dinamico = 1;
+            inicio = cortes[i - 1];
+        }
+        if (dinamico) {
+            INFO("[MANAGER] Trabajo %u: %zu bytes superan el límite de MPI_Scatterv; se reparte a demanda.\n",
+                 job, tamano_datos);
+            free(cortes);
         }
+    }
+    if (dinamico) {
+        anunciar(CTRL_TRABAJO, MODO_DINAMICO, job, &q);
+        INFO("[MANAGER] Trabajo %u: %d workers piden chunks a demanda...\n", job, num_procs - 1);
+        difundir_clave(clave);
+        repartir_dinamico(datos_cifrados, tamano_datos, clave, num_procs, job);
+        recolectar_resultados(num_procs, job, &q, resultado);
+        return;
+    }
+    anunciar(CTRL_TRABAJO, MODO_REPARTO, job, &q);
+    INFO("[MANAGER] Trabajo %u: distribuyendo a %d workers...\n", job, num_procs - 1);
 
-        char global_best_word[100] = "";
-        int global_max_count = 0;
+    // 1. La clave viaja una sola vez a todos con MPI_Bcast
+    difundir_clave(clave);
 
-        printf("[MANAGER] Esperando resultados de los workers...\n");
-        for (int i = 1; i < num_procs; ++i) {
-            char local_best_word[100];
-            int local_max_count;
+    // 2. reparto[2*i] = offset y reparto[2*i+1] = tamaño del chunk del rank i (rank 0 no recibe).
+    uint64_t *reparto = calloc(2 * num_procs, sizeof(uint64_t));
+    int *counts = calloc(2 * num_procs, sizeof(int));
+    if (!reparto || !counts) {
+        fprintf(stderr, "[MANAGER] No se pudo alojar memoria para el reparto.\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    int *displs = counts + num_procs;
+    size_t inicio = 0;
+    for (int i = 1; i < num_procs; ++i) {
+        reparto[2 * i] = inicio;
+        reparto[2 * i + 1] = cortes[i - 1] - inicio;
+        inicio = cortes[i - 1];
+    }
+    for (int i = 1; i < num_procs; ++i) {
+        counts[i] = (int)reparto[2 * i + 1];
+        displs[i] = (int)reparto[2 * i];
+        INFO("    -> Enviando %zu bytes al Worker %d (offset %zu)\n",
+               (size_t)reparto[2 * i + 1], i, (size_t)reparto[2 * i]);
+    }
 
-            MPI_Recv(&local_max_count, 1, MPI_INT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Recv(local_best_word, 100, MPI_CHAR, i, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            
-            printf("    <- Resultado del Worker %d: palabra='%s', frecuencia=%d\n", i, local_best_word, local_max_count);
+    // 3. Offsets/tamaños y datos en dos colectivas
+    uint64_t mi_reparto[2];
+    MPI_Scatter(reparto, 2, MPI_UINT64_T, mi_reparto, 2, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    MPI_Scatterv(datos_cifrados, counts, displs, MPI_UNSIGNED_CHAR,
+                 NULL, 0, MPI_UNSIGNED_CHAR, 0, MPI_COMM_WORLD);
+    free(reparto);
+    free(counts);
+    free(cortes);
+    registrar_fase("reparto", MPI_Wtime() - t0);
 
-            if (local_max_count > global_max_count) {
-                global_max_count = local_max_count;
-                strcpy(global_best_word, local_best_word);
-            }
+    recolectar_resultados(num_procs, job, &q, resultado);
+}
+
+// ================================================================
+// ===== LÓGICA DE LOS WORKERS (NODOS, RANK > 0) ==================
+// ================================================================
+static void worker_reparto(int rank, uint32_t job, const Consulta *q, TiemposWorker *tiempos) {
+    MPI_Comm comm_workers = obtener_comm_workers();
+    XorCipher cipher;
+    recibir_clave(rank, &cipher);
+
+    double t0 = MPI_Wtime();
+    uint64_t mi_reparto[2]; // offset y tamaño del chunk
+    MPI_Scatter(NULL, 2, MPI_UINT64_T, mi_reparto, 2, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    size_t mi_offset = mi_reparto[0];
+    size_t mi_tamano_chunk = mi_reparto[1];
+
+    unsigned char* mi_chunk_cifrado = malloc(mi_tamano_chunk ? mi_tamano_chunk : 1);
+    if (!mi_chunk_cifrado) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el chunk.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Scatterv(NULL, NULL, NULL, MPI_UNSIGNED_CHAR,
+                 mi_chunk_cifrado, (int)mi_tamano_chunk, MPI_UNSIGNED_CHAR, 0, MPI_COMM_WORLD);
+    tiempos->segundos[FASE_RECEPCION] = MPI_Wtime() - t0;
+
+    // Map: descifrar y contar localmente con todos los núcleos.
+    // Shuffle + reduce: sumar las palabras propias.
+    ContadorParalelo contador;
+    if (contador_iniciar(&contador, q->contadores) != 0) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el conteo.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (contador_procesar(&contador, &cipher, mi_chunk_cifrado, mi_tamano_chunk, mi_offset) != 0) {
+        fprintf(stderr, "[WORKER %d] Conteo local incompleto por falta de memoria.\n", rank);
+    }
+    free(mi_chunk_cifrado);
+    xor_cipher_free(&cipher);
+
+    terminar_conteo(rank, job, q, &contador, comm_workers, tiempos);
+}
+
+// ================================================================
+// ===== MODO FLUJO: BLOQUES ENVIADOS MIENTRAS LLEGAN DEL SOCKET ==
+// ================================================================
+// El manager llena un buffer mientras el otro viaja con MPI_Isend (doble buffer).
+// Antes de enviar, el bloque se corta en su último delimitador y el resto pasa
+// al inicio del otro buffer, así ninguna palabra queda repartida entre workers.
+
+#define CABECERA_BLOQUE sizeof(uint64_t)
+
+struct FlujoManager {
+    unsigned char *buffers[2];   // [offset u64][hasta BLOQUE_FLUJO bytes cifrados]
+    MPI_Request requests[2];
+    int actual;                  // Buffer que se está llenando
+    size_t lleno;                // Bytes de datos en el buffer actual
+    uint64_t offset;             // Offset absoluto del primer byte de datos del buffer actual
+    const char *clave;
+    size_t key_len;
+    int num_procs;
+    int siguiente_worker;
+    uint32_t job;
+    Consulta consulta;
+};
+
+// --- Busca hacia atrás el último delimitador del bloque (sobre el texto cifrado) ---
+// Devuelve la posición siguiente al delimitador, o 0 si el bloque no tiene ninguno.
+static size_t corte_en_ultimo_delimitador(const unsigned char *cifrado, size_t len, uint64_t offset,
+                                          const char *key, size_t key_len) {
+    if (len == 0) return 0;
+    const Tokenizer *tk = obtener_tokenizer();
+    size_t k = key_len ? (offset + len - 1) % key_len : 0;
+    for (size_t pos = len; pos > 0; --pos) {
+        unsigned char c = cifrado[pos - 1] ^ (key_len ? (unsigned char)key[k] : 0);
+        if (tokenizer_es_delimitador(tk, c)) return pos;
+        if (key_len) k = k ? k - 1 : key_len - 1;
+    }
+    return 0;
+}
+
+// --- Envía el buffer actual al siguiente worker y pasa a llenar el otro ---
+static void flujo_despachar(FlujoManager *f, int final) {
+    unsigned char *datos = f->buffers[f->actual] + CABECERA_BLOQUE;
+    size_t corte = f->lleno;
+    if (!final) {
+        size_t d = corte_en_ultimo_delimitador(datos, f->lleno, f->offset, f->clave, f->key_len);
+        if (d > 0) corte = d;
+    }
+
+    // El otro buffer tiene que haber terminado de viajar antes de reutilizarlo
+    int otro = 1 - f->actual;
+    MPI_Wait(&f->requests[otro], MPI_STATUS_IGNORE);
+    size_t resto = f->lleno - corte;
+    memcpy(f->buffers[otro] + CABECERA_BLOQUE, datos + corte, resto);
+
+    if (corte > 0) {
+        memcpy(f->buffers[f->actual], &f->offset, sizeof(uint64_t));
+        MPI_Isend(f->buffers[f->actual], (int)(CABECERA_BLOQUE + corte), MPI_UNSIGNED_CHAR,
+                  f->siguiente_worker, tag_de(f->job, TAG_BLOQUE), MPI_COMM_WORLD, &f->requests[f->actual]);
+        f->siguiente_worker = f->siguiente_worker % (f->num_procs - 1) + 1;
+    }
+    f->offset += corte;
+    f->lleno = resto;
+    f->actual = otro;
+}
+
+FlujoManager *flujo_iniciar(const char *clave) {
+    FlujoManager *f = calloc(1, sizeof(FlujoManager));
+    if (!f) return NULL;
+    f->buffers[0] = malloc(CABECERA_BLOQUE + BLOQUE_FLUJO);
+    f->buffers[1] = malloc(CABECERA_BLOQUE + BLOQUE_FLUJO);
+    if (!f->buffers[0] || !f->buffers[1]) {
+        free(f->buffers[0]);
+        free(f->buffers[1]);
+        free(f);
+        return NULL;
+    }
+    f->requests[0] = f->requests[1] = MPI_REQUEST_NULL;
+    f->clave = clave;
+    f->key_len = strlen(clave);
+    f->siguiente_worker = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &f->num_procs);
+
+    f->job = siguiente_job++;
+    f->consulta = consulta_configurada;
+    anunciar(CTRL_TRABAJO, MODO_FLUJO, f->job, &f->consulta);
+    difundir_clave(clave);
+    INFO("[MANAGER] Trabajo %u en modo flujo: bloques de %d bytes a %d workers.\n",
+           f->job, BLOQUE_FLUJO, f->num_procs - 1);
+    return f;
+}
+
+unsigned char *flujo_espacio(FlujoManager *f, size_t *disponible) {
+    if (f->lleno == BLOQUE_FLUJO) flujo_despachar(f, 0);
+    *disponible = BLOQUE_FLUJO - f->lleno;
+    return f->buffers[f->actual] + CABECERA_BLOQUE + f->lleno;
+}
+
+void flujo_avanzar(FlujoManager *f, size_t n) {
+    f->lleno += n;
+    if (f->lleno == BLOQUE_FLUJO) {
+        flujo_despachar(f, 0);
+    } else {
+        // Dar progreso al envío en curso mientras se sigue recibiendo del socket
+        int listo;
+        MPI_Test(&f->requests[1 - f->actual], &listo, MPI_STATUS_IGNORE);
+    }
+}
+
+void flujo_finalizar(FlujoManager *f, ResultadoCluster *resultado) {
+    if (f->lleno > 0) flujo_despachar(f, 1);
+    MPI_Waitall(2, f->requests, MPI_STATUSES_IGNORE);
+
+    for (int i = 1; i < f->num_procs; ++i) {
+        MPI_Send(NULL, 0, MPI_UNSIGNED_CHAR, i, tag_de(f->job, TAG_FIN), MPI_COMM_WORLD);
+    }
+    recolectar_resultados(f->num_procs, f->job, &f->consulta, resultado);
+
+    free(f->buffers[0]);
+    free(f->buffers[1]);
+    free(f);
+}
+
+static void worker_flujo(int rank, uint32_t job, const Consulta *q, TiemposWorker *tiempos) {
+    MPI_Comm comm_workers = obtener_comm_workers();
+
+    XorCipher cipher;
+    recibir_clave(rank, &cipher);
+
+    ContadorParalelo contador;
+    unsigned char *bloque = malloc(CABECERA_BLOQUE + BLOQUE_FLUJO);
+    if (!bloque || contador_iniciar(&contador, q->contadores) != 0) {
+        fprintf(stderr, "[WORKER %d] No se pudo alojar memoria para el modo flujo.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    for (;;) {
+        // Recepción: desde que se espera el bloque hasta tenerlo en memoria
+        double t0 = MPI_Wtime();
+        MPI_Status status;
+        MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (status.MPI_TAG == tag_de(job, TAG_FIN)) {
+            MPI_Recv(NULL, 0, MPI_UNSIGNED_CHAR, 0, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            tiempos->segundos[FASE_RECEPCION] += MPI_Wtime() - t0;
+            break;
         }
+        if (status.MPI_TAG != tag_de(job, TAG_BLOQUE)) {
+            fprintf(stderr, "[WORKER %d] Mensaje con tag %d fuera del trabajo %u.\n", rank, status.MPI_TAG, job);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        int n;
+        MPI_Get_count(&status, MPI_UNSIGNED_CHAR, &n);
+        MPI_Recv(bloque, n, MPI_UNSIGNED_CHAR, 0, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        tiempos->segundos[FASE_RECEPCION] += MPI_Wtime() - t0;
 
-        printf("[MANAGER] Proceso finalizado. Palabra más repetida: '%s' (%d veces).\n", global_best_word, global_max_count);
-        printf("[MANAGER] (Placeholder) Comandando al hardware para escribir '%s'...\n", global_best_word);
+        uint64_t offset;
+        memcpy(&offset, bloque, sizeof(uint64_t));
+        size_t tamano = n - CABECERA_BLOQUE;
+        if (contador_procesar(&contador, &cipher, bloque + CABECERA_BLOQUE, tamano, offset) != 0) {
+            fprintf(stderr, "[WORKER %d] Conteo local incompleto por falta de memoria.\n", rank);
+        }
     }
-    // ================================================================
-    // ===== LÓGICA DE LOS WORKERS (NODOS, RANK > 0) ==================
-    // ================================================================
-    else {
-        size_t mi_tamano_chunk;
-        char mi_clave[100];
-        
-        MPI_Recv(&mi_tamano_chunk, 1, MPI_UNSIGNED_LONG, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        
-        unsigned char* mi_chunk_cifrado = malloc(mi_tamano_chunk);
-        MPI_Recv(mi_chunk_cifrado, mi_tamano_chunk, MPI_UNSIGNED_CHAR, 0, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        
-        MPI_Status key_status;
-        MPI_Recv(mi_clave, 100, MPI_CHAR, 0, 2, MPI_COMM_WORLD, &key_status);
-
-        xor_decrypt_inplace(mi_clave, mi_chunk_cifrado, mi_tamano_chunk);
-        
-        char mi_palabra_frecuente[100];
-        int mi_frecuencia_max;
-        find_most_frequent_word(mi_chunk_cifrado, mi_tamano_chunk, mi_palabra_frecuente, &mi_frecuencia_max);
-        
-        MPI_Send(&mi_frecuencia_max, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-        MPI_Send(mi_palabra_frecuente, strlen(mi_palabra_frecuente) + 1, MPI_CHAR, 0, 1, MPI_COMM_WORLD);
-
-        free(mi_chunk_cifrado);
+    free(bloque);
+    xor_cipher_free(&cipher);
+
+    terminar_conteo(rank, job, q, &contador, comm_workers, tiempos);
+}
+
+// --- Bucle de servicio de los workers: un proceso atiende muchos trabajos seguidos ---
+void servicio_worker(void) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    for (;;) {
+        int control[5];
+        MPI_Bcast(control, 5, MPI_INT, 0, MPI_COMM_WORLD);
+        if (control[0] == CTRL_APAGAR) break;
+
+        uint32_t job = (uint32_t)control[2];
+        Consulta q = { control[3], control[4] };
+        TiemposWorker tiempos;
+        memset(&tiempos, 0, sizeof(tiempos));
+        tiempos.inicio = MPI_Wtime();
+        if (control[1] == MODO_FLUJO) {
+            worker_flujo(rank, job, &q, &tiempos);
+        } else if (control[1] == MODO_DINAMICO) {
+            worker_dinamico(rank, job, &q, &tiempos);
+        } else {
+            worker_reparto(rank, job, &q, &tiempos);
+        }
     }
 }
 
+void apagar_workers(void) {
+    INFO("[MANAGER] Apagando workers...\n");
+    anunciar(CTRL_APAGAR, 0, 0, &consulta_configurada);
+}
+
 // La inicialización y finalización de MPI se hace en el servidor principal
 // para envolver toda la ejecución de la aplicación.
\ No newline at end of file
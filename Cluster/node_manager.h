@@ -2,15 +2,153 @@
 #define NODE_MANAGER_H
 
 #include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint32_t
+
+#define MAX_PALABRA 100   // Tamaño de los buffers de palabra (incluye el '\0')
+#define BLOQUE_FLUJO (1 << 20) // Bytes de datos por bloque en modo flujo
+
+#define MAX_TOP 64         // Máximo de palabras en una consulta top-K
+
+/**
+ * @brief Una palabra del ranking. En modo exacto error es 0; en modo aproximado la
+ * frecuencia real está en [frecuencia - error, frecuencia].
+ */
+typedef struct {
+    char palabra[MAX_PALABRA];
+    long long frecuencia;   // 64 bits como la cota: los contadores Space-Saving lo son
+    long long error;
+} PalabraTop;
+
+/**
+ * @brief Resultado de un trabajo: la palabra más repetida y su frecuencia, y el
+ * ranking de las num_top más repetidas (top[0] es la misma palabra).
+ */
+typedef struct {
+    char palabra[MAX_PALABRA];
+    long long frecuencia;
+    uint32_t job_id;   // Número de trabajo que asignó el manager
+    int num_top;
+    int aproximado;    // 1 si el ranking salió de resúmenes Space-Saving
+    long long cota_error; // Modo aproximado: ninguna frecuencia se sobrestima en más que esto
+    PalabraTop top[MAX_TOP];
+} ResultadoCluster;
+
+/**
+ * @brief Prepara el cluster (comunicador de workers). Colectiva: todos los ranks
+ * la llaman una vez, justo después de MPI_Init.
+ * Aborta si hay menos de 2 procesos (hace falta al menos un worker).
+ */
+void inicializar_cluster(void);
+
+/**
+ * @brief Bucle de los workers (rank > 0): esperan el anuncio de cada trabajo, lo
+ * atienden en el modo que indique el manager y vuelven a esperar. Termina cuando
+ * rank 0 llama a apagar_workers().
+ */
+void servicio_worker(void);
 
 /**
- * @brief Simula la distribución de datos cifrados a los nodos de procesamiento.
- * * Esta función toma los datos cifrados, simula su división y envío a los nodos,
- * simula la recepción de resultados y la obtención de la palabra final.
+ * @brief Avisa a los workers que no habrá más trabajos (solo rank 0).
+ */
+void apagar_workers(void);
+
+/**
+ * @brief Distribuye los datos cifrados a los nodos de procesamiento (solo rank 0).
+ * * Rank 0 anuncia un trabajo nuevo, divide los datos en chunks alineados a palabras
+ * y los reparte; los workers (dentro de servicio_worker) descifran, cuentan y hacen
+ * el shuffle + reduce.
  * * @param datos_cifrados Puntero al buffer con los datos cifrados.
  * @param tamano_datos El tamaño del buffer de datos.
  * @param clave La clave necesaria para que los nodos puedan descifrar.
+ * @param resultado Donde rank 0 deja la palabra ganadora (puede ser NULL).
+ */
+void procesar_datos_distribuidos(const unsigned char *datos_cifrados, size_t tamano_datos, const char *clave,
+                                 ResultadoCluster *resultado);
+
+/**
+ * @brief Cantidad de hilos con que cada worker descifra y cuenta su chunk.
+ * 0 (por defecto) usa un hilo por núcleo. Llamar antes de procesar.
+ */
+void configurar_hilos(int hilos);
+
+/**
+ * @brief Si dinamico no es 0, procesar_datos_distribuidos reparte en muchos chunks
+ * chicos que cada worker pide al quedar libre (tamaño guiado: decrece hacia el final),
+ * en lugar de un chunk igual por worker. Sirve con nodos de distinta velocidad.
+ * Solo hace falta llamarla en rank 0: el modo viaja con el anuncio del trabajo.
+ */
+void configurar_reparto_dinamico(int dinamico);
+
+/**
+ * @brief Consulta de los próximos trabajos (solo rank 0; viaja con el anuncio).
+ * @param k Cantidad de palabras del ranking (1 a MAX_TOP).
+ * @param contadores 0 para conteo exacto (todo el vocabulario, con shuffle entre
+ * workers). Si es mayor que 0, cada hilo de cada worker guarda solo esa cantidad
+ * de contadores Space-Saving: memoria fija sin importar el tamaño del corpus,
+ * ranking aproximado con cota de error total / contadores.
+ */
+void configurar_top(int k, int contadores);
+
+/**
+ * @brief Si plegar no es 0, las mayúsculas ASCII se cuentan como minúsculas
+ * ("The" y "the" son la misma palabra). Llamar en todos los ranks antes de procesar.
+ */
+void configurar_minusculas(int plegar);
+
+/**
+ * @brief Si silencio no es 0, el manager no imprime nada por trabajo ni por chunk
+ * (solo errores). Los tiempos por fase de rank 0 y de cada worker siguen yendo al
+ * registro de métricas (metricas.h).
+ */
+void configurar_silencio(int silencio);
+
+/**
+ * @brief Estado del manager en modo flujo (opaco). Guarda dos buffers de
+ * BLOQUE_FLUJO bytes: la memoria no depende del tamaño del archivo.
+ */
+typedef struct FlujoManager FlujoManager;
+
+/**
+ * @brief Inicia un trabajo en modo flujo (solo rank 0). Lo anuncia a los workers
+ * (dentro de servicio_worker) y les difunde la clave.
+ * @return El estado del flujo, o NULL si no hay memoria.
+ */
+FlujoManager *flujo_iniciar(const char *clave);
+
+/**
+ * @brief Devuelve dónde escribir los siguientes bytes cifrados (p. ej. con recv)
+ * y cuántos caben. Los datos se reciben directamente en el buffer de envío.
+ */
+unsigned char *flujo_espacio(FlujoManager *flujo, size_t *disponible);
+
+/**
+ * @brief Confirma n bytes escritos en flujo_espacio(). Cuando el bloque se llena se
+ * envía al siguiente worker con MPI_Isend mientras se llena el otro buffer.
+ */
+void flujo_avanzar(FlujoManager *flujo, size_t n);
+
+/**
+ * @brief Envía el último bloque, avisa el fin a los workers, recolecta el resultado
+ * y libera el estado.
+ */
+void flujo_finalizar(FlujoManager *flujo, ResultadoCluster *resultado);
+
+/**
+ * @brief Cortes del reparto estático (lo que hace rank 0 antes de MPI_Scatterv):
+ * divide el texto cifrado en 'partes' tramos parecidos sin partir palabras.
+ * @param cortes Arreglo de 'partes' elementos; cortes[i] es el fin del tramo i
+ * (el tramo i empieza en cortes[i - 1], o en 0) y cortes[partes - 1] == tamano.
+ */
+void calcular_cortes(const unsigned char *datos_cifrados, size_t tamano, const char *clave, int partes,
+                     size_t *cortes);
+
+/**
+ * @brief Cuenta las palabras del texto y devuelve la más frecuente.
+ * * @param text Texto ya descifrado (no necesita terminar en '\0').
+ * @param len Cantidad de bytes del texto.
+ * @param most_frequent Buffer de MAX_PALABRA bytes donde se copia la palabra.
+ * @param max_count Cantidad de apariciones de esa palabra.
  */
-void procesar_datos_distribuidos(const unsigned char *datos_cifrados, size_t tamano_datos, const char *clave);
+void find_most_frequent_word(const unsigned char* text, size_t len, char* most_frequent, int* max_count);
 
 #endif // NODE_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "planificador.h"
+
+#define MAX_PULSO 65535 // Un pulso más largo se parte en varios comandos (__le16)
+
+// --- Teclados ---
+
+static void agregar_fila(Teclado *t, const char *fila, double x0, double y) {
+    for (int i = 0; fila[i] && t->num_teclas < TECLADO_MAX_TECLAS; ++i) {
+        t->teclas[t->num_teclas++] = (Tecla){ (unsigned char)fila[i], x0 + i, y };
+    }
+}
+
+void teclado_qwerty(Teclado *t) {
+    memset(t, 0, sizeof(*t));
+    agregar_fila(t, "1234567890-'", 0, 0);
+    agregar_fila(t, "qwertyuiop", 0.5, 1);
+    agregar_fila(t, "asdfghjkl", 0.75, 2);
+    agregar_fila(t, "zxcvbnm", 1.25, 3);
+    t->ms_x = 120;
+    t->ms_y = 150;
+    t->pulsar_ms = 80;
+    t->inicio_x = 4.75; // Sobre la 'g'
+    t->inicio_y = 2;
+}
+
+int teclado_cargar(Teclado *t, const char *ruta) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) {
+        perror("[TECLADO] No se pudo abrir el archivo");
+        return -1;
+    }
+    teclado_qwerty(t);
+    Teclado leido = *t;
+    leido.num_teclas = 0;
+
+    char linea[128];
+    int num_linea = 0, ok = 1;
+    while (ok && fgets(linea, sizeof(linea), f)) {
+        num_linea++;
+        char *comentario = strchr(linea, '#');
+        if (comentario) *comentario = '\0';
+        char nombre[16];
+        double a, b;
+        int campos = sscanf(linea, "%15s %lf %lf", nombre, &a, &b);
+        if (campos <= 0) continue; // Línea vacía
+        if (strcmp(nombre, "ms_x") == 0 && campos == 2 && a > 0) {
+            leido.ms_x = a;
+        } else if (strcmp(nombre, "ms_y") == 0 && campos == 2 && a > 0) {
+            leido.ms_y = a;
+        } else if (strcmp(nombre, "pulsar") == 0 && campos == 2 && a >= 1 && a <= MAX_PULSO) {
+            leido.pulsar_ms = (unsigned short)a;
+        } else if (strcmp(nombre, "inicio") == 0 && campos == 3) {
+            leido.inicio_x = a;
+            leido.inicio_y = b;
+        } else if (strlen(nombre) == 1 && campos == 3 && leido.num_teclas < TECLADO_MAX_TECLAS) {
+            leido.teclas[leido.num_teclas++] = (Tecla){ (unsigned char)tolower((unsigned char)nombre[0]), a, b };
+        } else {
+            fprintf(stderr, "[TECLADO] %s:%d: línea inválida.\n", ruta, num_linea);
+            ok = 0;
+        }
+    }
+    fclose(f);
+    if (!ok) return -1;
+    if (leido.num_teclas == 0) {
+        memcpy(leido.teclas, t->teclas, sizeof(t->teclas));
+        leido.num_teclas = t->num_teclas;
+    }
+    *t = leido;
+    return 0;
+}
+
+static PosicionBrazo posicion_de(const Teclado *t, double x, double y) {
+    return (PosicionBrazo){ lround(x * t->ms_x), lround(y * t->ms_y) };
+}
+
+PosicionBrazo teclado_inicio(const Teclado *t) {
+    return posicion_de(t, t->inicio_x, t->inicio_y);
+}
+
+// --- Tiempo de ir de a a b: x e y corren juntos, manda el eje más largo ---
+static long tiempo_viaje(PosicionBrazo a, PosicionBrazo b) {
+    long dx = labs(b.x_ms - a.x_ms), dy = labs(b.y_ms - a.y_ms);
+    return dx > dy ? dx : dy;
+}
+
+// --- Armado del programa ---
+
+static int agregar_comando(ProgramaBrazo *prog, unsigned int ejes, const unsigned short ms[RH_NUM_EJES]) {
+    if (prog->largo + RH_MAX_COMANDO > prog->capacidad) {
+        size_t capacidad = prog->capacidad ? prog->capacidad * 2 : 256;
+        Cmd *nuevo = realloc(prog->comandos, capacidad);
+        if (!nuevo) return -1;
+        prog->comandos = nuevo;
+        prog->capacidad = capacidad;
+    }
+    prog->largo += Biblioteca_CodificarEjes(prog->comandos + prog->largo, ejes, ms);
+    prog->movimientos++;
+    unsigned short mayor = 0;
+    for (int e = 0; e < RH_NUM_EJES; ++e) {
+        if ((ejes & (1u << e)) && ms[e] > mayor) mayor = ms[e];
+    }
+    prog->ms_total += mayor;
+    return 0;
+}
+
+// Desplazamiento en diagonal: un comando con los dos ejes (más si pasa de MAX_PULSO)
+static int agregar_viaje(ProgramaBrazo *prog, PosicionBrazo desde, PosicionBrazo hasta) {
+    long dx = hasta.x_ms - desde.x_ms, dy = hasta.y_ms - desde.y_ms;
+    int eje_x = dx > 0 ? RH_EJE_DERECHA : RH_EJE_IZQUIERDA;
+    int eje_y = dy > 0 ? RH_EJE_ATRAS : RH_EJE_ADELANTE;
+    long resto_x = labs(dx), resto_y = labs(dy);
+    while (resto_x > 0 || resto_y > 0) {
+        unsigned short ms[RH_NUM_EJES] = { 0 };
+        unsigned int ejes = 0;
+        if (resto_x > 0) {
+            ms[eje_x] = (unsigned short)(resto_x < MAX_PULSO ? resto_x : MAX_PULSO);
+            resto_x -= ms[eje_x];
+            ejes |= 1u << eje_x;
+        }
+        if (resto_y > 0) {
+            ms[eje_y] = (unsigned short)(resto_y < MAX_PULSO ? resto_y : MAX_PULSO);
+            resto_y -= ms[eje_y];
+            ejes |= 1u << eje_y;
+        }
+        if (agregar_comando(prog, ejes, ms) != 0) return -1;
+    }
+    return 0;
+}
+
+static int agregar_pulsacion(ProgramaBrazo *prog, unsigned short pulsar_ms) {
+    unsigned short ms[RH_NUM_EJES] = { 0 };
+    ms[RH_EJE_BAJAR] = ms[RH_EJE_SUBIR] = pulsar_ms;
+    if (agregar_comando(prog, 1u << RH_EJE_BAJAR, ms) != 0) return -1;
+    return agregar_comando(prog, 1u << RH_EJE_SUBIR, ms);
+}
+
+static int misma_tecla(const Tecla *tecla, unsigned char c) {
+    return tecla->caracter == (unsigned char)tolower(c);
+}
+
+// --- Planificación ---
+// Camino mínimo por capas (Viterbi): la capa i son las teclas del i-ésimo carácter
+// escribible y el costo de un paso es tiempo_viaje. Las pulsaciones cuestan lo mismo
+// en cualquier camino, así que no entran en la comparación.
+int planificar_palabra(const Teclado *t, PosicionBrazo desde, const char *palabra, ProgramaBrazo *prog) {
+    memset(prog, 0, sizeof(*prog));
+    prog->final = desde;
+
+    // Caracteres con tecla (los demás se cuentan y se saltean)
+    size_t largo = strlen(palabra), n = 0;
+    unsigned char *escribir = malloc(largo + 1);
+    int *previo = malloc((largo + 1) * TECLADO_MAX_TECLAS * sizeof(int));
+    if (!escribir || !previo) {
+        free(escribir);
+        free(previo);
+        return -1;
+    }
+    for (size_t i = 0; i < largo; ++i) {
+        unsigned char c = (unsigned char)palabra[i];
+        int hay = 0;
+        for (int k = 0; k < t->num_teclas && !hay; ++k) hay = misma_tecla(&t->teclas[k], c);
+        if (hay) {
+            escribir[n++] = c;
+        } else {
+            prog->omitidos++;
+        }
+    }
+
+    PosicionBrazo pos[TECLADO_MAX_TECLAS];
+    long costo[TECLADO_MAX_TECLAS], siguiente[TECLADO_MAX_TECLAS];
+    for (int k = 0; k < t->num_teclas; ++k) pos[k] = posicion_de(t, t->teclas[k].x, t->teclas[k].y);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < t->num_teclas; ++k) {
+            siguiente[k] = -1;
+            previo[i * TECLADO_MAX_TECLAS + k] = -1;
+            if (!misma_tecla(&t->teclas[k], escribir[i])) continue;
+            if (i == 0) {
+                siguiente[k] = tiempo_viaje(desde, pos[k]);
+                continue;
+            }
+            for (int j = 0; j < t->num_teclas; ++j) {
+                if (costo[j] < 0) continue;
+                long c = costo[j] + tiempo_viaje(pos[j], pos[k]);
+                if (siguiente[k] < 0 || c < siguiente[k]) {
+                    siguiente[k] = c;
+                    previo[i * TECLADO_MAX_TECLAS + k] = j;
+                }
+            }
+        }
+        memcpy(costo, siguiente, sizeof(costo));
+    }
+
+    // Reconstruye las teclas de atrás hacia adelante y emite el programa en orden
+    int ret = 0;
+    if (n > 0) {
+        int mejor = -1;
+        for (int k = 0; k < t->num_teclas; ++k) {
+            if (costo[k] >= 0 && (mejor < 0 || costo[k] < costo[mejor])) mejor = k;
+        }
+        int *camino = malloc(n * sizeof(int));
+        if (!camino) {
+            ret = -1;
+        } else {
+            for (size_t i = n; i-- > 0;) {
+                camino[i] = mejor;
+                mejor = previo[i * TECLADO_MAX_TECLAS + mejor];
+            }
+            PosicionBrazo actual = desde;
+            for (size_t i = 0; i < n && ret == 0; ++i) {
+                ret = agregar_viaje(prog, actual, pos[camino[i]]);
+                if (ret == 0) ret = agregar_pulsacion(prog, t->pulsar_ms);
+                actual = pos[camino[i]];
+            }
+            prog->final = actual;
+            free(camino);
+        }
+    }
+    free(escribir);
+    free(previo);
+    if (ret != 0) programa_brazo_free(prog);
+    return ret;
+}
+
+PosicionBrazo programa_brazo_posicion(const ProgramaBrazo *prog, PosicionBrazo desde, size_t bytes) {
+    const unsigned char *p = (const unsigned char *)prog->comandos;
+    if (bytes > prog->largo) bytes = prog->largo;
+    size_t i = 0;
+    while (i < bytes) {
+        // El planificador solo arma comandos de ejes (RH_OP_EJES)
+        unsigned int ejes = p[i] & RH_MASCARA_EJES;
+        size_t largo = 1 + 2 * (size_t)__builtin_popcount(ejes);
+        if (i + largo > bytes) break;
+        const unsigned char *ms = p + i + 1;
+        for (int e = 0; e < RH_NUM_EJES; ++e) {
+            if (!(ejes & (1u << e))) continue;
+            long v = ms[0] | (ms[1] << 8);
+            ms += 2;
+            if (e == RH_EJE_DERECHA) desde.x_ms += v;
+            if (e == RH_EJE_IZQUIERDA) desde.x_ms -= v;
+            if (e == RH_EJE_ATRAS) desde.y_ms += v;
+            if (e == RH_EJE_ADELANTE) desde.y_ms -= v;
+        }
+        i += largo;
+    }
+    return desde;
+}
+
+void programa_brazo_free(ProgramaBrazo *prog) {
+    free(prog->comandos);
+    prog->comandos = NULL;
+    prog->largo = prog->capacidad = 0;
+}
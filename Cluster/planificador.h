@@ -0,0 +1,96 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <stddef.h> // Para size_t
+#include "biblioteca.h" // Para Cmd y el formato de los comandos
+
+#define TECLADO_MAX_TECLAS 128
+
+/**
+ * @brief Una tecla del teclado: el carácter que escribe y su centro, en unidades
+ * del teclado (p. ej. anchos de tecla). x crece hacia la derecha (eje D) y y hacia
+ * el usuario (eje T); una tecla se pulsa bajando (B) y subiendo (S) el dedo.
+ */
+typedef struct {
+    unsigned char caracter;
+    double x, y;
+} Tecla;
+
+/**
+ * @brief Disposición del teclado y velocidad del brazo. Un carácter puede estar en
+ * más de una tecla; el planificador usa la que acorte el recorrido.
+ */
+typedef struct {
+    Tecla teclas[TECLADO_MAX_TECLAS];
+    int num_teclas;
+    double ms_x;                // ms de pulso D/I por unidad de x
+    double ms_y;                // ms de pulso A/T por unidad de y
+    unsigned short pulsar_ms;   // Pulso de B y de S en cada pulsación
+    double inicio_x, inicio_y;  // Dónde está el brazo al arrancar el servidor
+} Teclado;
+
+/**
+ * @brief Posición del brazo en ms de recorrido desde el origen del teclado. Se
+ * lleva en enteros para que los redondeos de un movimiento no se acumulen.
+ */
+typedef struct {
+    long x_ms, y_ms;
+} PosicionBrazo;
+
+/**
+ * @brief Programa de movimiento: comandos de robotic_hand_cmd.h listos para enviar
+ * con un solo Biblioteca_SendCommands.
+ */
+typedef struct {
+    Cmd *comandos;
+    size_t largo;
+    size_t capacidad;
+    int movimientos;    // Comandos del programa
+    int omitidos;       // Caracteres de la palabra que no están en el teclado
+    double ms_total;    // Tiempo del brazo: suma del eje más largo de cada comando
+    PosicionBrazo final; // Dónde queda el brazo al terminar
+} ProgramaBrazo;
+
+/**
+ * @brief Teclado QWERTY de una fila de números y tres de letras (escalonadas como
+ * en un teclado real), con '-' y '\''. 120 ms por tecla en x, 150 ms en y.
+ */
+void teclado_qwerty(Teclado *t);
+
+/**
+ * @brief Lee un teclado de un archivo de texto, una directiva por línea ('#' comenta):
+ *   ms_x <ms>  |  ms_y <ms>  |  pulsar <ms>  |  inicio <x> <y>  |  <carácter> <x> <y>
+ * Lo que no se indica queda como en teclado_qwerty(), salvo las teclas: si el
+ * archivo trae alguna, reemplazan a todas las del QWERTY.
+ * @return 0 en éxito, -1 si no se puede leer o una línea no es válida.
+ */
+int teclado_cargar(Teclado *t, const char *ruta);
+
+/**
+ * @brief Posición inicial del brazo según el teclado.
+ */
+PosicionBrazo teclado_inicio(const Teclado *t);
+
+/**
+ * @brief Arma el programa que escribe la palabra desde 'desde' con el menor tiempo
+ * de brazo. Los desplazamientos en x y en y van en un mismo comando (los dos ejes
+ * corren juntos, el tiempo es el del más largo) y, si un carácter está en varias
+ * teclas, elige la combinación de teclas de menor tiempo total. Las mayúsculas
+ * ASCII se escriben con su minúscula; los caracteres sin tecla se saltean.
+ * @return 0 en éxito, -1 si no hay memoria. Libera con programa_brazo_free().
+ */
+int planificar_palabra(const Teclado *t, PosicionBrazo desde, const char *palabra, ProgramaBrazo *prog);
+
+/**
+ * @brief Dónde queda el brazo si de un programa que arrancó en 'desde' solo se
+ * ejecutan los primeros 'bytes' (p. ej. los que aceptó el driver antes de un error).
+ * Un comando cortado al final no cuenta.
+ */
+PosicionBrazo programa_brazo_posicion(const ProgramaBrazo *prog, PosicionBrazo desde, size_t bytes);
+
+/**
+ * @brief Libera el programa.
+ */
+void programa_brazo_free(ProgramaBrazo *prog);
+
+#endif // PLANIFICADOR_H
@@ -0,0 +1,106 @@
+#ifndef PROTOCOLO_V2_H
+#define PROTOCOLO_V2_H
+
+#include <stdint.h> // Para uint64_t, uint32_t
+#include <string.h> // Para memcpy
+#include <endian.h> // Para htobe64/be64toh
+#include "hash_contenido.h"
+
+/**
+ * Protocolo de subida versión 2 (cliente -> servidor en modo epoll).
+ *
+ * La versión 1 empieza con el tamaño del archivo (8 bytes big-endian) y sigue con
+ * todos los datos por una sola conexión. En la 2 todo va en tramas de TRAMA_V2_BYTES
+ * que empiezan con V2_MAGIA, así el servidor distingue las versiones por los primeros
+ * 4 bytes (un tamaño v1 que empezara así pasaría de los 4 EiB).
+ *
+ * Una subida se identifica con un id de 64 bits que elige el cliente y puede usar
+ * varias conexiones a la vez:
+ *   1. Cada conexión abre con V2_HOLA (valor = tamaño total, largo = flujos) y el
+ *      servidor responde V2_ESTADO con valor = bytes ya confirmados desde el inicio.
+ *      Si la subida ya existía (el cliente se cortó), se reanuda desde ahí.
+ *   2. V2_TROZO (valor = offset, largo = bytes, suma = suma_trozo de los datos
+ *      cifrados) seguido de los datos. El servidor los recibe directo en el archivo
+ *      de la subida, en su offset, y responde V2_ACK con el mismo offset y largo, o
+ *      V2_RECHAZO si la suma no coincide (el cliente lo vuelve a mandar).
+ *   3. Con todo confirmado, el cliente cierra las demás conexiones y manda V2_FIN por
+ *      una; por esa misma recibe el resultado, igual que en la versión 1.
+ * Todos los enteros van en big-endian.
+ */
+
+#define V2_MAGIA "BRZ2"
+#define TRAMA_V2_BYTES 32
+#define MAX_TROZO_V2 (16u << 20) // Bytes de datos por trama, como máximo
+
+enum {
+    V2_HOLA = 1,
+    V2_TROZO = 2,
+    V2_FIN = 3,
+    V2_ESTADO = 0x81,
+    V2_ACK = 0x82,
+    V2_RECHAZO = 0x83,
+};
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t flujo;      // Conexión del cliente que manda la trama (solo informativo)
+    uint64_t id;        // Id de la subida
+    uint64_t valor;     // Tamaño total, offset o bytes confirmados, según el tipo
+    uint32_t largo;
+    uint32_t suma;
+} TramaV2;
+
+/**
+ * @brief Serializa la trama en 'buf' (TRAMA_V2_BYTES bytes).
+ */
+static inline void trama_v2_escribir(unsigned char *buf, const TramaV2 *t) {
+    uint64_t id = htobe64(t->id), valor = htobe64(t->valor);
+    uint32_t largo = htobe32(t->largo), suma = htobe32(t->suma);
+    memcpy(buf, V2_MAGIA, 4);
+    buf[4] = t->tipo;
+    buf[5] = t->flujo;
+    buf[6] = buf[7] = 0;
+    memcpy(buf + 8, &id, 8);
+    memcpy(buf + 16, &valor, 8);
+    memcpy(buf + 24, &largo, 4);
+    memcpy(buf + 28, &suma, 4);
+}
+
+/**
+ * @brief Indica si los bytes empiezan con V2_MAGIA (alcanza con los primeros 4).
+ */
+static inline int trama_v2_es_magia(const unsigned char *buf) {
+    return memcmp(buf, V2_MAGIA, 4) == 0;
+}
+
+/**
+ * @brief Lee una trama de 'buf'. @return 0, o -1 si no empieza con V2_MAGIA.
+ */
+static inline int trama_v2_leer(const unsigned char *buf, TramaV2 *t) {
+    uint64_t id, valor;
+    uint32_t largo, suma;
+    if (!trama_v2_es_magia(buf)) return -1;
+    memcpy(&id, buf + 8, 8);
+    memcpy(&valor, buf + 16, 8);
+    memcpy(&largo, buf + 24, 4);
+    memcpy(&suma, buf + 28, 4);
+    t->tipo = buf[4];
+    t->flujo = buf[5];
+    t->id = be64toh(id);
+    t->valor = be64toh(valor);
+    t->largo = be32toh(largo);
+    t->suma = be32toh(suma);
+    return 0;
+}
+
+/**
+ * @brief Suma de control de los datos de un trozo: los 32 bits bajos del XXH64.
+ */
+static inline uint32_t suma_trozo(const void *datos, size_t len) {
+    HashFlujo h;
+    hash_flujo_iniciar(&h, 0);
+    hash_flujo_agregar(&h, datos, len);
+    return (uint32_t)hash_flujo_valor(&h);
+}
+
+#endif // PROTOCOLO_V2_H
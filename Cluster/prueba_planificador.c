@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "planificador.h"
+
+// Prueba del planificador contra un brazo simulado: ejecuta el programa comando por
+// comando (mismo formato que el driver), cuenta movimientos y tiempo, y anota qué
+// tecla queda debajo del dedo en cada bajada. No necesita el driver ni MPI.
+
+#define MOCK "prueba_planificador.mock"
+#define PULSO_POR_DEFECTO 100 // PULSE_MS del driver (letras y ejes con ms 0)
+
+typedef struct {
+    PosicionBrazo pos;
+    int abajo;
+    int movimientos;
+    int arrastres;      // Desplazamientos con el dedo abajo (no deberían existir)
+    double ms;
+    char escrito[256];
+    size_t largo;
+} BrazoSimulado;
+
+static int fallos = 0;
+
+#define VERIFICAR(cond, ...) do { \
+    if (!(cond)) { printf("  FALLO: " __VA_ARGS__); printf("\n"); fallos++; } \
+} while (0)
+
+// --- Un comando del brazo: todos los ejes de la máscara arrancan juntos ---
+static void simular_pulsos(BrazoSimulado *b, const Teclado *t, unsigned int ejes, const unsigned int ms[RH_NUM_EJES],
+                           unsigned int repeticiones) {
+    unsigned int mayor = 0;
+    for (int e = 0; e < RH_NUM_EJES; ++e) {
+        if ((ejes & (1u << e)) && ms[e] > mayor) mayor = ms[e];
+    }
+    for (unsigned int r = 0; r < repeticiones; ++r) {
+        long dx = 0, dy = 0;
+        if (ejes & (1u << RH_EJE_DERECHA)) dx += ms[RH_EJE_DERECHA];
+        if (ejes & (1u << RH_EJE_IZQUIERDA)) dx -= ms[RH_EJE_IZQUIERDA];
+        if (ejes & (1u << RH_EJE_ATRAS)) dy += ms[RH_EJE_ATRAS];
+        if (ejes & (1u << RH_EJE_ADELANTE)) dy -= ms[RH_EJE_ADELANTE];
+        if ((dx || dy) && b->abajo) b->arrastres++;
+        b->pos.x_ms += dx;
+        b->pos.y_ms += dy;
+        if ((ejes & (1u << RH_EJE_BAJAR)) && !b->abajo) {
+            // Pulsa la tecla que está justo debajo, o '?' si no hay ninguna
+            char c = '?';
+            for (int k = 0; k < t->num_teclas; ++k) {
+                if (lround(t->teclas[k].x * t->ms_x) == b->pos.x_ms && lround(t->teclas[k].y * t->ms_y) == b->pos.y_ms) {
+                    c = (char)t->teclas[k].caracter;
+                    break;
+                }
+            }
+            if (b->largo + 1 < sizeof(b->escrito)) b->escrito[b->largo++] = c;
+            b->abajo = 1;
+        }
+        if (ejes & (1u << RH_EJE_SUBIR)) b->abajo = 0;
+        b->ms += mayor;
+    }
+    b->movimientos++;
+}
+
+// --- Decodifica el programa como lo hace el driver (robotic_hand_cmd.h) ---
+static void simular(BrazoSimulado *b, const Teclado *t, PosicionBrazo desde, const Cmd *comandos, size_t n) {
+    const unsigned char *prog = (const unsigned char *)comandos;
+    memset(b, 0, sizeof(*b));
+    b->pos = desde;
+    size_t i = 0;
+    while (i < n) {
+        unsigned int ms[RH_NUM_EJES] = { 0 };
+        unsigned char op = prog[i++];
+        if ((op & ~RH_MASCARA_EJES) == RH_OP_EJES) {
+            unsigned int ejes = op & RH_MASCARA_EJES;
+            for (int e = 0; e < RH_NUM_EJES; ++e) {
+                if (!(ejes & (1u << e)) || i + 2 > n) continue;
+                ms[e] = prog[i] | (prog[i + 1] << 8);
+                if (ms[e] == 0) ms[e] = PULSO_POR_DEFECTO;
+                i += 2;
+            }
+            simular_pulsos(b, t, ejes, ms, 1);
+        } else if ((op & ~7) == RH_OP_PASOS && i + 2 <= n) {
+            unsigned int eje = op & 7, pasos = prog[i] | (prog[i + 1] << 8);
+            i += 2;
+            ms[eje] = PULSO_POR_DEFECTO;
+            if (pasos) simular_pulsos(b, t, 1u << eje, ms, pasos);
+        } else if (op && strchr(RH_LETRAS_EJES, op)) {
+            int eje = (int)(strchr(RH_LETRAS_EJES, op) - RH_LETRAS_EJES);
+            ms[eje] = PULSO_POR_DEFECTO;
+            simular_pulsos(b, t, 1u << eje, ms, 1);
+        }
+    }
+}
+
+// --- Referencia: primera tecla de cada carácter, x e y en comandos separados ---
+static double tiempo_ingenuo(const Teclado *t, PosicionBrazo desde, const char *palabra) {
+    double ms = 0;
+    for (size_t i = 0; palabra[i]; ++i) {
+        for (int k = 0; k < t->num_teclas; ++k) {
+            if (t->teclas[k].caracter != tolower((unsigned char)palabra[i])) continue;
+            PosicionBrazo p = { lround(t->teclas[k].x * t->ms_x), lround(t->teclas[k].y * t->ms_y) };
+            ms += labs(p.x_ms - desde.x_ms) + labs(p.y_ms - desde.y_ms) + 2.0 * t->pulsar_ms;
+            desde = p;
+            break;
+        }
+    }
+    return ms;
+}
+
+// --- Programa cortado después de cada comando (y a mitad de uno): la posición que
+// calcula el planificador es donde quedó el brazo ---
+static void probar_cortes(const Teclado *t, PosicionBrazo desde, const ProgramaBrazo *prog) {
+    const unsigned char *p = (const unsigned char *)prog->comandos;
+    size_t corte = 0;
+    for (;;) {
+        BrazoSimulado b;
+        simular(&b, t, desde, prog->comandos, corte);
+        PosicionBrazo pos = programa_brazo_posicion(prog, desde, corte);
+        if (pos.x_ms != b.pos.x_ms || pos.y_ms != b.pos.y_ms) {
+            VERIFICAR(0, "cortado en el byte %zu, el plan ubica mal al brazo", corte);
+            return;
+        }
+        if (corte == prog->largo) return;
+        pos = programa_brazo_posicion(prog, desde, corte + 1);
+        VERIFICAR(pos.x_ms == b.pos.x_ms && pos.y_ms == b.pos.y_ms, "un comando cortado se contó como ejecutado");
+        corte += 1 + 2 * (size_t)__builtin_popcount(p[corte] & RH_MASCARA_EJES);
+    }
+}
+
+// --- Planifica, simula y compara con lo que se esperaba escribir ---
+static void probar(const char *nombre, const Teclado *t, const char *palabra, const char *esperado, int omitidos) {
+    PosicionBrazo desde = teclado_inicio(t);
+    ProgramaBrazo prog;
+    BrazoSimulado b;
+    printf("%s: '%s'\n", nombre, palabra);
+    if (planificar_palabra(t, desde, palabra, &prog) != 0) {
+        VERIFICAR(0, "planificar_palabra devolvió error");
+        return;
+    }
+    simular(&b, t, desde, prog.comandos, prog.largo);
+    double ingenuo = tiempo_ingenuo(t, desde, palabra);
+    printf("  %d comandos, %.0f ms de brazo (en serie y sin elegir tecla: %.0f ms)\n", prog.movimientos, prog.ms_total,
+           ingenuo);
+
+    b.escrito[b.largo] = '\0';
+    VERIFICAR(strcmp(b.escrito, esperado) == 0, "escribió '%s', se esperaba '%s'", b.escrito, esperado);
+    VERIFICAR(prog.omitidos == omitidos, "%d omitidos, se esperaban %d", prog.omitidos, omitidos);
+    VERIFICAR(b.movimientos == prog.movimientos, "el brazo hizo %d comandos, el plan dice %d", b.movimientos,
+              prog.movimientos);
+    VERIFICAR(b.ms == prog.ms_total, "el brazo tardó %.0f ms, el plan dice %.0f", b.ms, prog.ms_total);
+    VERIFICAR(b.arrastres == 0, "%d desplazamientos con el dedo abajo", b.arrastres);
+    VERIFICAR(!b.abajo, "el dedo quedó abajo");
+    VERIFICAR(b.pos.x_ms == prog.final.x_ms && b.pos.y_ms == prog.final.y_ms, "el brazo no quedó donde dice el plan");
+    VERIFICAR(prog.ms_total <= ingenuo, "el plan es más lento que la referencia");
+    probar_cortes(t, desde, &prog);
+    programa_brazo_free(&prog);
+}
+
+// --- El programa sale en un solo write por Biblioteca y el brazo lo ejecuta igual ---
+static void probar_envio(const Teclado *t, const char *palabra) {
+    PosicionBrazo desde = teclado_inicio(t);
+    ProgramaBrazo prog;
+    Biblioteca_Contadores antes, despues;
+    BrazoSimulado b;
+    printf("Envío en un lote: '%s'\n", palabra);
+
+    BD fd = Biblioteca_OpenMock(MOCK);
+    if (fd < 0 || planificar_palabra(t, desde, palabra, &prog) != 0) {
+        VERIFICAR(0, "no se pudo abrir el mock o planificar");
+        return;
+    }
+    Biblioteca_LeerContadores(&antes);
+    VERIFICAR(Biblioteca_SendCommands(fd, prog.comandos, prog.largo) == 0, "Biblioteca_SendCommands falló");
+    Biblioteca_LeerContadores(&despues);
+    Biblioteca_Close(fd);
+    printf("  %zu bytes en %lu syscall(s)\n", prog.largo, despues.syscalls - antes.syscalls);
+    VERIFICAR(despues.syscalls - antes.syscalls == 1, "se esperaba un solo write");
+
+    Cmd leido[4096];
+    FILE *f = fopen(MOCK, "rb");
+    size_t n = f ? fread(leido, 1, sizeof(leido), f) : 0;
+    if (f) fclose(f);
+    remove(MOCK);
+    VERIFICAR(n == prog.largo, "el dispositivo recibió %zu bytes de %zu", n, prog.largo);
+    simular(&b, t, desde, leido, n);
+    b.escrito[b.largo] = '\0';
+    VERIFICAR(strcmp(b.escrito, palabra) == 0, "el dispositivo escribió '%s'", b.escrito);
+    programa_brazo_free(&prog);
+}
+
+int main(int argc, char *argv[]) {
+    Teclado qwerty;
+    teclado_qwerty(&qwerty);
+    if (argc > 1) {
+        // ./prueba_planificador <teclado> <palabra>: solo muestra el plan de esa palabra
+        Teclado t;
+        if (teclado_cargar(&t, argv[1]) != 0) return 1;
+        probar("Teclado de archivo", &t, argc > 2 ? argv[2] : "hola", argc > 2 ? argv[2] : "hola", 0);
+        return fallos ? 1 : 0;
+    }
+
+    probar("QWERTY", &qwerty, "hola", "hola", 0);
+    probar("Letras repetidas", &qwerty, "llamarla", "llamarla", 0);
+    probar("Mayúsculas y sin tecla", &qwerty, "Ni\xc3\xb1o's", "nio's", 2);
+    probar("Palabra vacía", &qwerty, "", "", 0);
+
+    // Dos teclas 'e': en cada pulsación conviene la que deja más cerca de la siguiente
+    Teclado doble;
+    teclado_qwerty(&doble);
+    doble.num_teclas = 0;
+    doble.teclas[doble.num_teclas++] = (Tecla){ 'e', 0, 0 };
+    doble.teclas[doble.num_teclas++] = (Tecla){ 'e', 9, 0 };
+    doble.teclas[doble.num_teclas++] = (Tecla){ 'a', 1, 1 };
+    doble.teclas[doble.num_teclas++] = (Tecla){ 'z', 8, 1 };
+    doble.inicio_x = 4.5;
+    doble.inicio_y = 0;
+    probar("Teclas duplicadas", &doble, "azeaze", "azeaze", 0);
+
+    // Recorridos de más de 65535 ms se parten en varios comandos
+    Teclado lento = doble;
+    lento.ms_x = 30000;
+    probar("Pulsos largos", &lento, "eze", "eze", 0);
+
+    probar_envio(&qwerty, "robotica");
+
+    printf(fallos ? "%d verificación(es) fallida(s).\n" : "Todas las verificaciones pasaron.\n", fallos);
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/bash
+# Este script compila y ejecuta la prueba del planificador de teclas contra el brazo
+# simulado (no necesita el driver ni MPI).
+#
+# Uso: ./prueba_planificador.sh                      todas las verificaciones
+#      ./prueba_planificador.sh <teclado> <palabra>  plan de una palabra con otro teclado
+
+echo "Compilando prueba_planificador.c..."
+
+gcc -Wall -O2 -I../Biblioteca -pthread -o prueba_planificador prueba_planificador.c planificador.c \
+    ../Biblioteca/biblioteca.c -lm
+
+if [ $? -eq 0 ]; then
+    echo "¡Compilación exitosa!"
+    echo "-------------------------------------"
+    ./prueba_planificador "$@"
+else
+    echo "¡Error de compilación!"
+    exit 1
+fi
@@ -0,0 +1,46 @@
+#!/bin/bash
+# Este script prueba una subida más grande que el límite de MPI_Scatterv (2 GiB) en el
+# reparto estático por defecto: el trabajo debe pasar al reparto dinámico y responder
+# la misma palabra que el mismo texto en chico. Necesita unos GiB de disco libres.
+#
+# Uso: ./prueba_reparto_grande.sh [tamaño] [puerto]
+#   ./prueba_reparto_grande.sh 3G 9098
+
+TAMANO=${1:-3G}
+PUERTO=${2:-9098}
+CLAVE=prueba_grande
+CORPUS=corpus/sat_${TAMANO}_s1.txt
+
+echo "Compilando generar_corpus, servidor y cliente..."
+
+gcc -Wall -O2 -o generar_corpus generar_corpus.c -lm && \
+mpicc -Wall -O2 -I../Biblioteca -o servidor servidor.c node_manager.c word_table.c xor_cipher.c tokenizer.c space_saving.c hash_contenido.c cache_resultados.c metricas.c planificador.c ../Biblioteca/biblioteca.c -pthread -lm && \
+gcc -Wall -O2 -pthread -o cliente cliente.c xor_cipher.c hash_contenido.c
+
+if [ $? -ne 0 ]; then
+    echo "¡Error de compilación!"
+    exit 1
+fi
+echo "¡Compilación exitosa!"
+echo "-------------------------------------"
+
+mkdir -p corpus
+if [ ! -f "$CORPUS" ]; then
+    echo "Generando $CORPUS..."
+    ./generar_corpus sat "$TAMANO" "$CORPUS" 1 || exit 1
+fi
+
+# Un solo worker: su chunk es todo el archivo, bien por encima de INT_MAX
+mpirun -np 2 ./servidor "$PUERTO" "$CLAVE" --cache 0 > prueba_reparto_grande.log 2>&1 &
+SERVIDOR=$!
+trap 'kill -INT "$SERVIDOR" 2>/dev/null; wait "$SERVIDOR" 2>/dev/null' EXIT
+sleep 2
+
+RESPUESTA=$(./cliente 127.0.0.1 "$PUERTO" "$CORPUS" "$CLAVE" 2>&1 | grep "RESULTADO")
+echo "$RESPUESTA"
+if grep -q "a demanda" prueba_reparto_grande.log && echo "$RESPUESTA" | grep -q "RESULTADO the "; then
+    echo "OK: la subida pasó al reparto dinámico y respondió la palabra."
+else
+    echo "FALLO: ver prueba_reparto_grande.log"
+    exit 1
+fi
@@ -1,12 +1,67 @@
+#define _GNU_SOURCE // Para accept4
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
 #include "node_manager.h"
+#include "hash_contenido.h"
+#include "cache_resultados.h"
+#include "metricas.h"
+#include "planificador.h"
+#include "protocolo_v2.h"
 #include <mpi.h>
 
+#define MAX_EVENTOS 64
+#define MAX_SUBIDA_DEFECTO (8ULL << 30) // 8 GiB; se cambia con --max-subida
+
+#define CACHE_DEFECTO 128 // Resultados guardados; se cambia con --cache (0 la desactiva)
+#define RUTA_CACHE "archivo_recibido.cache"
+#define RUTA_METRICAS_DEFECTO "servidor_metricas.prom" // Texto de Prometheus; se cambia con --metricas
+
+static uint64_t max_subida = MAX_SUBIDA_DEFECTO;
+
+// --quiet: sin mensajes por conexión ni por trabajo (los tiempos quedan en las métricas)
+static int silencioso = 0;
+
+#define INFO(...) do { if (!silencioso) printf(__VA_ARGS__); } while (0)
+
+// Caché de resultados (solo rank 0). La clave de cada subida combina el hash del
+// contenido cifrado, sembrado con la clave, y la firma de la consulta configurada.
+static CacheResultados cache;
+static uint64_t semilla_clave;
+static uint64_t firma_consulta;
+
+// Brazo (solo rank 0): la palabra ganadora de cada trabajo se escribe en el teclado.
+// Sin --brazo se planifica igual y solo se informa el plan. El brazo queda sobre la
+// última tecla, así que el plan siguiente arranca desde ahí.
+// El dispatcher planifica y encola; un hilo propio envía, porque el write espera
+// cuando la cola del driver está llena y eso no debe frenar el próximo trabajo.
+#define COLA_BRAZO 8    // Programas en espera; con la cola llena la palabra se descarta
+
+typedef struct {
+    ProgramaBrazo prog;
+    PosicionBrazo desde;
+} ProgramaEncolado;
+
+static Teclado teclado;
+static PosicionBrazo posicion_brazo;    // Al terminar todo lo encolado
+static BD fd_brazo = -1;
+static ProgramaEncolado cola_brazo[COLA_BRAZO];
+static int brazo_primero, brazo_en_cola, brazo_apagar;
+static pthread_mutex_t brazo_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t brazo_cond = PTHREAD_COND_INITIALIZER;
+
 void die_with_error(const char *message) {
     perror(message);
     exit(EXIT_FAILURE);
@@ -23,56 +78,888 @@ int recv_all(int socket, void *buffer, size_t length) {
     return 0;
 }
 
-void handle_client(int client_socket, const char *key) {
+int send_all(int socket, const void *buffer, size_t length) {
+    const unsigned char *ptr = (const unsigned char*) buffer;
+    while (length > 0) {
+        ssize_t i = send(socket, ptr, length, MSG_NOSIGNAL);
+        if (i < 0 && errno == EINTR) continue;
+        if (i < 1) return -1;
+        ptr += i;
+        length -= i;
+    }
+    return 0;
+}
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// --- Tiempo de una fase de rank 0 en el histograma servidor_fase_segundos ---
+static void registrar_fase(const char *fase, double ms) {
+    char etiquetas[48];
+    snprintf(etiquetas, sizeof(etiquetas), "fase=\"%s\"", fase);
+    metricas_observar("servidor_fase_segundos", etiquetas, ms / 1e3);
+}
+
+// --- Escribe la palabra ganadora: un programa de movimiento enviado en un solo lote ---
+// Va después de responder al cliente. Solo planifica y encola: no espera al brazo.
+static void escribir_con_brazo(const ResultadoCluster *r) {
+    if (r->palabra[0] == '\0') return;
+    double t0 = ahora_ms();
+    ProgramaBrazo prog;
+    int encolado = 0;
+    pthread_mutex_lock(&brazo_mutex);
+    int ok = planificar_palabra(&teclado, posicion_brazo, r->palabra, &prog) == 0;
+    if (ok && fd_brazo >= 0 && brazo_en_cola < COLA_BRAZO) {
+        cola_brazo[(brazo_primero + brazo_en_cola++) % COLA_BRAZO] = (ProgramaEncolado){ prog, posicion_brazo };
+        posicion_brazo = prog.final;
+        encolado = 1;
+        pthread_cond_signal(&brazo_cond);
+    }
+    pthread_mutex_unlock(&brazo_mutex);
+    if (!ok) {
+        fprintf(stderr, "[BRAZO] Sin memoria para planificar '%s'.\n", r->palabra);
+        return;
+    }
+    registrar_fase("brazo", ahora_ms() - t0);
+    metricas_observar("servidor_brazo_estimado_segundos", NULL, prog.ms_total / 1e3);
+    INFO("[BRAZO] '%s': %d comandos, %.1f s de brazo estimados%s%s.\n", r->palabra, prog.movimientos,
+         prog.ms_total / 1e3, prog.omitidos ? ", caracteres sin tecla omitidos" : "",
+         encolado ? "" : fd_brazo >= 0 ? " (cola del brazo llena; se descarta)" : " (no enviado al dispositivo)");
+    if (!encolado) programa_brazo_free(&prog);
+}
+
+// --- Hilo del brazo: envía los programas en orden ---
+// Si un envío falla a mitad, el brazo quedó donde lo dejaron los comandos aceptados:
+// se replanifica desde ahí y lo encolado detrás (planificado desde otro lado) se descarta.
+static void *hilo_brazo(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&brazo_mutex);
+    for (;;) {
+        while (brazo_en_cola == 0 && !brazo_apagar) pthread_cond_wait(&brazo_cond, &brazo_mutex);
+        if (brazo_apagar) break;
+        ProgramaEncolado e = cola_brazo[brazo_primero];
+        brazo_primero = (brazo_primero + 1) % COLA_BRAZO;
+        brazo_en_cola--;
+        pthread_mutex_unlock(&brazo_mutex);
+
+        size_t aceptados;
+        int rc = Biblioteca_SendCommandsParcial(fd_brazo, e.prog.comandos, e.prog.largo, &aceptados);
+
+        pthread_mutex_lock(&brazo_mutex);
+        if (rc != 0) {
+            fprintf(stderr, "[BRAZO] El driver aceptó %zu de %zu bytes; %d palabra(s) en espera descartadas.\n",
+                    aceptados, e.prog.largo, brazo_en_cola);
+            posicion_brazo = programa_brazo_posicion(&e.prog, e.desde, aceptados);
+            for (; brazo_en_cola > 0; brazo_en_cola--) {
+                programa_brazo_free(&cola_brazo[brazo_primero].prog);
+                brazo_primero = (brazo_primero + 1) % COLA_BRAZO;
+            }
+        }
+        programa_brazo_free(&e.prog);
+    }
+    // Al apagar no se espera al brazo: lo que no salió se descarta
+    for (; brazo_en_cola > 0; brazo_en_cola--) {
+        programa_brazo_free(&cola_brazo[brazo_primero].prog);
+        brazo_primero = (brazo_primero + 1) % COLA_BRAZO;
+    }
+    pthread_mutex_unlock(&brazo_mutex);
+    return NULL;
+}
+
+// --- Rechazo de una subida más grande que --max-subida (se avisa antes de recibir nada) ---
+static void rechazar_subida(int client_socket, uint64_t tamano) {
+    char linea[96];
+    int n = snprintf(linea, sizeof(linea), "ERROR subida de %llu bytes supera el máximo de %llu\n",
+                     (unsigned long long)tamano, (unsigned long long)max_subida);
+    send(client_socket, linea, n, MSG_NOSIGNAL);
+    fprintf(stderr, "[SERVIDOR] Subida de %llu bytes rechazada (máximo %llu).\n",
+            (unsigned long long)tamano, (unsigned long long)max_subida);
+}
+
+// --- Respuesta al cliente: una línea con el resultado del trabajo y, si se pidió un
+// ranking, una línea "TOP <puesto> <palabra> <frecuencia> <error>" por palabra ---
+static void enviar_resultado(int client_socket, const ResultadoCluster *resultado) {
+    char texto[(MAX_TOP + 2) * (MAX_PALABRA + 48)];
+    int n = snprintf(texto, sizeof(texto), "RESULTADO %s %lld\n", resultado->palabra, resultado->frecuencia);
+    if (resultado->num_top > 1 || resultado->aproximado) {
+        for (int i = 0; i < resultado->num_top; ++i) {
+            n += snprintf(texto + n, sizeof(texto) - n, "TOP %d %s %lld %lld\n", i + 1,
+                          resultado->top[i].palabra, resultado->top[i].frecuencia, resultado->top[i].error);
+        }
+        if (resultado->aproximado) {
+            n += snprintf(texto + n, sizeof(texto) - n, "COTA %lld\n", resultado->cota_error);
+        }
+    }
+    if (send_all(client_socket, texto, n) != 0) {
+        fprintf(stderr, "[HANDLER] No se pudo enviar el resultado al cliente.\n");
+    }
+}
+
+// ================================================================
+// ===== FRONT END EPOLL: MUCHOS CLIENTES SUBIENDO A LA VEZ =======
+// ================================================================
+// Un hilo acepta y recibe de todos los clientes con sockets no bloqueantes.
+// Cada subida completa pasa a una cola; el hilo principal (el único que usa
+// MPI) la despacha al cluster y responde a cada cliente en su propio socket.
+// Las subidas no pasan por el heap: se reciben directo en un archivo reservado
+// con fallocate y mapeado con mmap, y el reparto lee los chunks de ese mapeo.
+// Así una subida puede ser más grande que la RAM (las páginas se pueden desalojar).
+// Con el protocolo v2 (protocolo_v2.h) una subida llega por varias conexiones en
+// trozos con offset: cada trozo se recibe directo en su lugar del mapeo.
+
+typedef enum {
+    LEYENDO_TAMANO,     // Primeros 8 bytes: tamaño v1 o comienzo de una trama v2
+    LEYENDO_DATOS,      // v1: el resto de la conexión son los datos
+    LEYENDO_TRAMA,      // v2: cabecera de la próxima trama
+    LEYENDO_TROZO,      // v2: datos de un V2_TROZO
+    ESPERANDO_RESULTADO // v2: mandó V2_FIN; no debería llegar nada más
+} EstadoConexion;
+
+struct SubidaPendiente;
+
+typedef struct Conexion {
+    int fd;
+    EstadoConexion estado;
+    unsigned char cabecera[TRAMA_V2_BYTES]; // v1 usa solo los primeros 8 bytes
+    size_t cabecera_leida;
+    uint64_t tamano;
+    uint64_t recibido;
+    int archivo_fd;             // Archivo temporal de la subida (-1 si todavía no hay)
+    char ruta[64];
+    unsigned char *datos;       // Mapeo del archivo (NULL si la subida está vacía)
+    HashFlujo hash;             // Hash del contenido, calculado mientras llega
+    int hash_pendiente;         // v2: los trozos llegaron desordenados; lo calcula el dispatcher
+    double t_aceptada;          // Para la latencia por trabajo
+    double t_recibida;
+    char origen[INET_ADDRSTRLEN + 8];
+    struct SubidaPendiente *subida; // v2: subida de esta conexión (NULL antes de V2_HOLA)
+    TramaV2 trozo;              // v2: trozo que se está recibiendo
+    unsigned char *destino;     // v2: dónde van los próximos bytes del trozo
+    uint32_t trozo_recibido;
+    struct Conexion *sig;       // Enlace dentro de la cola de trabajos
+} Conexion;
+
+// --- Subidas v2 a medias (solo el hilo epoll) ---
+// Una subida sigue aquí mientras le falten bytes, aunque se corten todas sus
+// conexiones: el cliente vuelve con el mismo id y reanuda desde lo confirmado.
+// Con la tabla llena se descarta la más vieja que no tenga conexiones.
+#define MAX_SUBIDAS_V2 16
+#define MAX_RANGOS_V2 256   // Tramos recibidos y verificados, separados entre sí
+
+typedef struct {
+    uint64_t inicio, fin;
+} Rango;
+
+typedef struct SubidaPendiente {
+    int usada;
+    uint64_t id;
+    uint64_t tamano;
+    int archivo_fd;
+    char ruta[64];
+    unsigned char *datos;
+    Rango rangos[MAX_RANGOS_V2]; // Ordenados y sin tocarse
+    int num_rangos;
+    int conexiones;             // Conexiones abiertas que mandaron V2_HOLA
+    Conexion *fin;              // Mandó V2_FIN y espera que se cierren las demás
+    double t_aceptada;          // Primera conexión, para la latencia del trabajo
+    double t_uso;               // Última actividad
+} SubidaPendiente;
+
+static SubidaPendiente subidas[MAX_SUBIDAS_V2];
+
+static Conexion *cola_inicio = NULL, *cola_fin = NULL;
+static size_t cola_largo = 0;
+static pthread_mutex_t cola_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cola_cond = PTHREAD_COND_INITIALIZER;
+
+static void cola_push(Conexion *c) {
+    pthread_mutex_lock(&cola_mutex);
+    c->sig = NULL;
+    if (cola_fin) cola_fin->sig = c; else cola_inicio = c;
+    cola_fin = c;
+    cola_largo++;
+    pthread_cond_signal(&cola_cond);
+    pthread_mutex_unlock(&cola_mutex);
+}
+
+static Conexion *cola_pop(size_t *en_espera) {
+    pthread_mutex_lock(&cola_mutex);
+    while (!cola_inicio) pthread_cond_wait(&cola_cond, &cola_mutex);
+    Conexion *c = cola_inicio;
+    cola_inicio = c->sig;
+    if (!cola_inicio) cola_fin = NULL;
+    cola_largo--;
+    *en_espera = cola_largo;
+    pthread_mutex_unlock(&cola_mutex);
+    return c;
+}
+
+static void cerrar_conexion(Conexion *c) {
+    if (c->fd >= 0) close(c->fd);
+    if (c->datos) munmap(c->datos, c->tamano);
+    if (c->archivo_fd >= 0) {
+        close(c->archivo_fd);
+        unlink(c->ruta); // No-op si el dispatcher ya lo renombró
+    }
+    free(c);
+}
+
+// --- Reserva el archivo de una subida y lo mapea para recibir directo en él ---
+// Deja abierto lo que alcanzó a crear (archivo_fd, datos) para que el llamador lo libere.
+static int reservar_archivo(uint64_t tamano, char ruta[64], int *archivo_fd, unsigned char **datos, int secuencial) {
+    static unsigned siguiente_subida = 0; // Solo lo usa el hilo epoll
+    snprintf(ruta, 64, ".subida_%u.cif", siguiente_subida++);
+    *archivo_fd = open(ruta, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (*archivo_fd < 0) {
+        perror("[EPOLL] No se pudo crear el archivo de la subida");
+        return -1;
+    }
+    if (tamano == 0) return 0;
+
+    // fallocate reserva los bloques ahora: si el disco no alcanza se sabe antes de recibir
+    int rc = posix_fallocate(*archivo_fd, 0, (off_t)tamano);
+    if (rc != 0) {
+        fprintf(stderr, "[EPOLL] No se pudo reservar %llu bytes en disco: %s\n",
+                (unsigned long long)tamano, strerror(rc));
+        return -1;
+    }
+    void *mapa = mmap(NULL, tamano, PROT_READ | PROT_WRITE, MAP_SHARED, *archivo_fd, 0);
+    if (mapa == MAP_FAILED) {
+        perror("[EPOLL] No se pudo mapear el archivo de la subida");
+        return -1;
+    }
+    if (secuencial) madvise(mapa, tamano, MADV_SEQUENTIAL);
+    *datos = mapa;
+    return 0;
+}
+
+static int preparar_archivo(Conexion *c) {
+    return reservar_archivo(c->tamano, c->ruta, &c->archivo_fd, &c->datos, 1);
+}
+
+// ----- Protocolo v2 -----
+
+static void liberar_subida(SubidaPendiente *s) {
+    if (s->datos) munmap(s->datos, s->tamano);
+    if (s->archivo_fd >= 0) {
+        close(s->archivo_fd);
+        unlink(s->ruta);
+    }
+    s->usada = 0;
+}
+
+// Bytes confirmados sin huecos desde el inicio: desde ahí reanuda el cliente
+static uint64_t prefijo_confirmado(const SubidaPendiente *s) {
+    return s->num_rangos > 0 && s->rangos[0].inicio == 0 ? s->rangos[0].fin : 0;
+}
+
+// --- Marca [inicio, fin) como recibido, fundiéndolo con los rangos que toca ---
+// -1 si haría falta un rango más y no hay lugar (el trozo se rechaza y se reenvía).
+static int agregar_rango(SubidaPendiente *s, uint64_t inicio, uint64_t fin) {
+    int i = 0;
+    while (i < s->num_rangos && s->rangos[i].fin < inicio) i++;
+    int j = i; // Rangos [i, j) se funden con el nuevo
+    while (j < s->num_rangos && s->rangos[j].inicio <= fin) j++;
+    if (i == j) {
+        if (s->num_rangos == MAX_RANGOS_V2) return -1;
+        memmove(&s->rangos[i + 1], &s->rangos[i], (s->num_rangos - i) * sizeof(Rango));
+        s->rangos[i] = (Rango){ inicio, fin };
+        s->num_rangos++;
+        return 0;
+    }
+    if (s->rangos[i].inicio < inicio) inicio = s->rangos[i].inicio;
+    if (s->rangos[j - 1].fin > fin) fin = s->rangos[j - 1].fin;
+    s->rangos[i] = (Rango){ inicio, fin };
+    memmove(&s->rangos[i + 1], &s->rangos[j], (s->num_rangos - j) * sizeof(Rango));
+    s->num_rangos -= j - i - 1;
+    return 0;
+}
+
+// --- Quita [inicio, fin) de lo confirmado (un trozo corrupto pudo pisar datos buenos) ---
+// Si partir un rango no entra, se descarta también la parte de arriba: confirmar de
+// menos solo cuesta reenviar.
+static void quitar_rango(SubidaPendiente *s, uint64_t inicio, uint64_t fin) {
+    for (int i = 0; i < s->num_rangos; ++i) {
+        Rango *r = &s->rangos[i];
+        if (r->fin <= inicio || r->inicio >= fin) continue;
+        if (r->inicio < inicio && r->fin > fin && s->num_rangos < MAX_RANGOS_V2) {
+            memmove(&s->rangos[i + 2], &s->rangos[i + 1], (s->num_rangos - i - 1) * sizeof(Rango));
+            s->rangos[i + 1] = (Rango){ fin, r->fin };
+            s->num_rangos++;
+            r->fin = inicio;
+            return;
+        }
+        if (r->inicio < inicio) {
+            r->fin = inicio;
+            continue;
+        }
+        if (r->fin > fin) {
+            r->inicio = fin;
+            continue;
+        }
+        memmove(r, r + 1, (s->num_rangos - i - 1) * sizeof(Rango)); // Queda cubierto entero
+        s->num_rangos--;
+        i--;
+    }
+}
+
+// --- Subida con ese id (misma longitud), o una nueva si no existe ---
+static SubidaPendiente *buscar_subida(uint64_t id, uint64_t tamano, double t_aceptada) {
+    SubidaPendiente *libre = NULL;
+    for (int i = 0; i < MAX_SUBIDAS_V2; ++i) {
+        SubidaPendiente *s = &subidas[i];
+        if (s->usada && s->id == id) return s->tamano == tamano ? s : NULL;
+        if (!s->usada) {
+            if (!libre) libre = s;
+        } else if (s->conexiones == 0 && (!libre || (libre->usada && s->t_uso < libre->t_uso))) {
+            libre = s; // Abandonada: se puede desalojar si no hay lugar libre
+        }
+    }
+    if (!libre) return NULL;
+    if (libre->usada) {
+        fprintf(stderr, "[EPOLL] Subida v2 %016llx abandonada; se descarta.\n", (unsigned long long)libre->id);
+        liberar_subida(libre);
+    }
+    memset(libre, 0, sizeof(*libre));
+    libre->archivo_fd = -1;
+    if (reservar_archivo(tamano, libre->ruta, &libre->archivo_fd, &libre->datos, 0) != 0) {
+        liberar_subida(libre);
+        return NULL;
+    }
+    libre->usada = 1;
+    libre->id = id;
+    libre->tamano = tamano;
+    libre->t_aceptada = t_aceptada;
+    libre->t_uso = ahora_ms();
+    return libre;
+}
+
+// --- La subida completa pasa a la conexión que mandó V2_FIN, que será el trabajo ---
+static void tomar_subida(Conexion *c, SubidaPendiente *s) {
+    c->tamano = c->recibido = s->tamano;
+    c->archivo_fd = s->archivo_fd;
+    memcpy(c->ruta, s->ruta, sizeof(c->ruta));
+    c->datos = s->datos;
+    c->t_aceptada = s->t_aceptada;
+    // Los trozos llegaron en cualquier orden: el hash no se puede llevar mientras llegan,
+    // y hashear todo aquí frenaría a las demás conexiones del hilo epoll
+    c->hash_pendiente = 1;
+    c->subida = NULL;
+    s->usada = 0;
+}
+
+// --- Se cierra una conexión v2. Devuelve la conexión con V2_FIN si ahora puede ser trabajo ---
+static Conexion *soltar_subida(Conexion *c) {
+    SubidaPendiente *s = c->subida;
+    if (!s) return NULL;
+    c->subida = NULL;
+    s->conexiones--;
+    s->t_uso = ahora_ms();
+    if (s->fin == c) s->fin = NULL;
+    if (!s->fin || s->conexiones != 1) return NULL;
+    Conexion *fin = s->fin;
+    tomar_subida(fin, s);
+    return fin;
+}
+
+static int enviar_trama(int fd, uint8_t tipo, uint64_t id, uint64_t valor, uint32_t largo) {
+    unsigned char buf[TRAMA_V2_BYTES];
+    TramaV2 t = { .tipo = tipo, .id = id, .valor = valor, .largo = largo };
+    trama_v2_escribir(buf, &t);
+    return send_all(fd, buf, sizeof(buf)); // 32 bytes: entran en el buffer del socket
+}
+
+// --- Trama v2 completa en c->cabecera: 0 para seguir, 1 si la subida es un trabajo, -1 error ---
+static int procesar_trama(Conexion *c) {
+    TramaV2 t;
+    if (trama_v2_leer(c->cabecera, &t) != 0) return -1;
+    SubidaPendiente *s = c->subida;
+    if (!s && t.tipo != V2_HOLA) return -1;
+    if (s && t.id != s->id) return -1;
+
+    switch (t.tipo) {
+    case V2_HOLA:
+        if (s) return -1;
+        if (t.valor > max_subida) {
+            rechazar_subida(c->fd, t.valor);
+            return -1;
+        }
+        s = buscar_subida(t.id, t.valor, c->t_aceptada);
+        if (!s) {
+            fprintf(stderr, "[EPOLL] %s: no hay lugar para la subida v2 %016llx (o cambió de tamaño).\n",
+                    c->origen, (unsigned long long)t.id);
+            return -1;
+        }
+        s->conexiones++;
+        c->subida = s;
+        INFO("[EPOLL] %s: flujo %u de %u de la subida v2 %016llx (%llu bytes, %llu ya confirmados).\n",
+             c->origen, t.flujo + 1, t.largo, (unsigned long long)t.id, (unsigned long long)t.valor,
+             (unsigned long long)prefijo_confirmado(s));
+        return enviar_trama(c->fd, V2_ESTADO, s->id, prefijo_confirmado(s), 0);
+    case V2_TROZO:
+        if (t.largo == 0 || t.largo > MAX_TROZO_V2 || t.valor > s->tamano || t.largo > s->tamano - t.valor) {
+            fprintf(stderr, "[EPOLL] %s: trozo fuera de rango.\n", c->origen);
+            return -1;
+        }
+        c->trozo = t;
+        c->destino = s->datos + t.valor;
+        c->trozo_recibido = 0;
+        c->estado = LEYENDO_TROZO;
+        return 0;
+    case V2_FIN:
+        if (prefijo_confirmado(s) != s->tamano) {
+            fprintf(stderr, "[EPOLL] %s: V2_FIN con la subida incompleta.\n", c->origen);
+            return -1;
+        }
+        c->estado = ESPERANDO_RESULTADO;
+        s->fin = c;
+        if (s->conexiones > 1) return 0; // Espera que se cierren los otros flujos
+        tomar_subida(c, s);
+        return 1;
+    default:
+        return -1;
+    }
+}
+
+// --- Trozo recibido: se verifica la suma y se confirma (o se rechaza para que se reenvíe) ---
+static int terminar_trozo(Conexion *c) {
+    SubidaPendiente *s = c->subida;
+    const TramaV2 *t = &c->trozo;
+    int ok = suma_trozo(s->datos + t->valor, t->largo) == t->suma;
+    if (ok) {
+        ok = agregar_rango(s, t->valor, t->valor + t->largo) == 0;
+    } else {
+        quitar_rango(s, t->valor, t->valor + t->largo);
+    }
+    s->t_uso = ahora_ms();
+    c->estado = LEYENDO_TRAMA;
+    return enviar_trama(c->fd, ok ? V2_ACK : V2_RECHAZO, s->id, t->valor, t->largo);
+}
+
+// --- Lee lo disponible sin bloquear: 1 si la subida terminó, 0 si falta, -1 si hubo
+// error, 2 si un flujo v2 cerró entre tramas (terminó su parte) ---
+static int leer_conexion(Conexion *c) {
+    for (;;) {
+        unsigned char *destino;
+        size_t quiero;
+        unsigned char descarte[1];
+        if (c->estado == LEYENDO_TAMANO) {
+            destino = c->cabecera + c->cabecera_leida;
+            quiero = sizeof(uint64_t) - c->cabecera_leida;
+        } else if (c->estado == LEYENDO_TRAMA) {
+            destino = c->cabecera + c->cabecera_leida;
+            quiero = TRAMA_V2_BYTES - c->cabecera_leida;
+        } else if (c->estado == LEYENDO_TROZO) {
+            destino = c->destino;
+            quiero = c->trozo.largo - c->trozo_recibido;
+        } else if (c->estado == ESPERANDO_RESULTADO) {
+            destino = descarte; // Solo para notar si el cliente cierra
+            quiero = sizeof(descarte);
+        } else {
+            if (c->recibido == c->tamano) return 1;
+            destino = c->datos + c->recibido;
+            quiero = c->tamano - c->recibido;
+        }
+
+        ssize_t n = recv(c->fd, destino, quiero, 0);
+        if (n == 0) {
+            // El cliente cerró: un flujo v2 puede hacerlo entre tramas; si no, faltaba algo
+            return c->subida && c->estado == LEYENDO_TRAMA && c->cabecera_leida == 0 ? 2 : -1;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        if (c->estado == LEYENDO_TRAMA) {
+            c->cabecera_leida += n;
+            if (c->cabecera_leida < TRAMA_V2_BYTES) continue;
+            c->cabecera_leida = 0;
+            int rc = procesar_trama(c);
+            if (rc != 0) return rc;
+        } else if (c->estado == LEYENDO_TROZO) {
+            c->destino += n;
+            c->trozo_recibido += n;
+            if (c->trozo_recibido == c->trozo.largo && terminar_trozo(c) != 0) return -1;
+        } else if (c->estado == ESPERANDO_RESULTADO) {
+            return -1; // Nada debería llegar después de V2_FIN
+        } else if (c->estado == LEYENDO_TAMANO) {
+            c->cabecera_leida += n;
+            if (c->cabecera_leida < sizeof(uint64_t)) continue;
+            if (trama_v2_es_magia(c->cabecera)) {
+                c->estado = LEYENDO_TRAMA; // El resto de la cabecera se lee como trama v2
+                continue;
+            }
+            uint64_t net_size;
+            memcpy(&net_size, c->cabecera, sizeof(net_size));
+            c->tamano = be64toh(net_size);
+            if (c->tamano > max_subida) {
+                rechazar_subida(c->fd, c->tamano);
+                return -1;
+            }
+            if (preparar_archivo(c) != 0) return -1;
+            hash_flujo_iniciar(&c->hash, semilla_clave);
+            c->estado = LEYENDO_DATOS;
+            INFO("[EPOLL] %s enviará %zu bytes.\n", c->origen, (size_t)c->tamano);
+        } else {
+            hash_flujo_agregar(&c->hash, destino, n);
+            c->recibido += n;
+        }
+    }
+}
+
+static void aceptar_clientes(int server_socket, int epfd) {
+    for (;;) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+        int fd = accept4(server_socket, (struct sockaddr *)&client_addr, &addr_len, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("Error en accept, continuando...");
+            }
+            return;
+        }
+
+        Conexion *c = calloc(1, sizeof(Conexion));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->archivo_fd = -1;
+        c->estado = LEYENDO_TAMANO;
+        c->t_aceptada = ahora_ms();
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+        snprintf(c->origen, sizeof(c->origen), "%s:%d", client_ip, ntohs(client_addr.sin_port));
+
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = c };
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("Error en epoll_ctl");
+            cerrar_conexion(c);
+            continue;
+        }
+        INFO("\n[EPOLL] Petición de conexión de %s.\n", c->origen);
+    }
+}
+
+// --- Señal de apagado: una Conexion con fd -1 al final de la cola ---
+// El dispatcher termina los trabajos ya encolados, apaga los workers y vuelve.
+static void encolar_apagado(void) {
+    Conexion *fin = calloc(1, sizeof(Conexion));
+    if (!fin) die_with_error("Error al encolar el apagado");
+    fin->fd = -1;
+    fin->archivo_fd = -1;
+    cola_push(fin);
+}
+
+typedef struct {
+    int server_socket;
+    int senal_fd;               // signalfd con SIGINT/SIGTERM
+} ArgsEpoll;
+
+static Conexion marca_senal;    // data.ptr del signalfd dentro de epoll
+
+static void *bucle_epoll(void *arg) {
+    ArgsEpoll *args = arg;
+    int server_socket = args->server_socket;
+    int epfd = epoll_create1(0);
+    if (epfd < 0) die_with_error("Error en epoll_create1");
+
+    // data.ptr == NULL identifica al socket de escucha
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, server_socket, &ev) < 0) die_with_error("Error en epoll_ctl");
+    struct epoll_event ev_senal = { .events = EPOLLIN, .data.ptr = &marca_senal };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, args->senal_fd, &ev_senal) < 0) die_with_error("Error en epoll_ctl");
+
+    struct epoll_event eventos[MAX_EVENTOS];
+    for (;;) {
+        int n = epoll_wait(epfd, eventos, MAX_EVENTOS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            die_with_error("Error en epoll_wait");
+        }
+        for (int i = 0; i < n; ++i) {
+            Conexion *c = eventos[i].data.ptr;
+            if (!c) {
+                aceptar_clientes(server_socket, epfd);
+                continue;
+            }
+            if (c == &marca_senal) {
+                struct signalfd_siginfo info;
+                if (read(args->senal_fd, &info, sizeof(info)) != sizeof(info)) continue;
+                printf("\n[EPOLL] Señal %u recibida: no se aceptan más clientes.\n", info.ssi_signo);
+                close(epfd);
+                for (int j = 0; j < MAX_SUBIDAS_V2; ++j) {
+                    if (subidas[j].usada) liberar_subida(&subidas[j]); // Subidas v2 a medias
+                }
+                encolar_apagado();
+                return NULL;
+            }
+            int rc = leer_conexion(c);
+            if (rc == 0) continue;
+            epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+            if (rc != 1) {
+                // Si era el último flujo v2 que faltaba cerrar, el que mandó V2_FIN pasa a trabajo
+                Conexion *fin = soltar_subida(c);
+                if (rc < 0) fprintf(stderr, "[EPOLL] Error al recibir de %s; se descarta.\n", c->origen);
+                cerrar_conexion(c);
+                if (!fin) continue;
+                epoll_ctl(epfd, EPOLL_CTL_DEL, fin->fd, NULL);
+                c = fin;
+            }
+            c->t_recibida = ahora_ms();
+            INFO("[EPOLL] Subida de %s completa; a la cola de trabajos.\n", c->origen);
+            cola_push(c);
+        }
+    }
+    return NULL;
+}
+
+// --- Dispatcher (hilo principal): un trabajo a la vez por el cluster ---
+static void despachar_trabajos(const char *key) {
+    for (;;) {
+        size_t en_espera;
+        Conexion *c = cola_pop(&en_espera);
+        if (c->fd < 0) {
+            free(c);
+            apagar_workers();
+            return;
+        }
+        double t_inicio = ahora_ms();
+        metricas_fijar("servidor_cola_trabajos", NULL, (double)en_espera);
+        INFO("[DISPATCHER] Procesando %zu bytes de %s (%zu en espera).\n",
+             (size_t)c->tamano, c->origen, en_espera);
+
+        // Guardar el archivo cifrado (Requisito del proyecto): la subida ya está en
+        // disco, basta renombrarla. El mapeo sigue siendo válido.
+        if (rename(c->ruta, "archivo_recibido.cif") == 0) {
+            INFO("[DISPATCHER] Archivo cifrado guardado en 'archivo_recibido.cif'.\n");
+        } else {
+            perror("[DISPATCHER] No se pudo guardar 'archivo_recibido.cif'");
+        }
+        double t_guardado = ahora_ms();
+
+        // Una subida ya vista con la misma clave y consulta se responde sin el cluster.
+        // El hash de una subida v2 es el mismo que tendría por v1: la caché las cruza
+        if (c->hash_pendiente) {
+            hash_flujo_iniciar(&c->hash, semilla_clave);
+            if (c->datos) hash_flujo_agregar(&c->hash, c->datos, c->tamano);
+        }
+        ClaveCache clave_cache = { hash_flujo_valor(&c->hash), c->tamano, firma_consulta };
+        ResultadoCluster resultado = { "", 0, 0 };
+        int acierto = cache_buscar(&cache, &clave_cache, &resultado);
+        double t_cluster = ahora_ms();
+        if (!acierto) {
+            procesar_datos_distribuidos(c->datos, c->tamano, key, &resultado);
+            // Un resultado vacío puede ser un error del reparto: no se guarda, así se reintenta
+            if (resultado.palabra[0] != '\0') cache_guardar(&cache, &clave_cache, &resultado);
+        }
+        if (cache.capacidad > 0) {
+            metricas_sumar(acierto ? "servidor_cache_aciertos_total" : "servidor_cache_fallos_total", NULL, 1);
+            INFO("[DISPATCHER] Caché: %s (%lu aciertos, %lu fallos).\n", acierto ? "acierto" : "fallo",
+                 cache.aciertos, cache.fallos);
+        }
+        double t_respuesta = ahora_ms();
+
+        // El socket vuelve a modo bloqueante: el hilo epoll ya no lo vigila
+        int flags = fcntl(c->fd, F_GETFL);
+        fcntl(c->fd, F_SETFL, flags & ~O_NONBLOCK);
+        enviar_resultado(c->fd, &resultado);
+
+        double t_fin = ahora_ms();
+        escribir_con_brazo(&resultado);
+        registrar_fase("subida", c->t_recibida - c->t_aceptada);
+        registrar_fase("cola", t_inicio - c->t_recibida);
+        registrar_fase("guardado", t_guardado - t_inicio);
+        registrar_fase("cache", t_cluster - t_guardado);
+        if (!acierto) registrar_fase("cluster", t_respuesta - t_cluster);
+        registrar_fase("respuesta", t_fin - t_respuesta);
+        registrar_fase("total", t_fin - c->t_aceptada);
+        metricas_sumar("servidor_trabajos_total", NULL, 1);
+        metricas_sumar("servidor_bytes_total", NULL, (double)c->tamano);
+        metricas_escribir();
+        INFO("[DISPATCHER] Trabajo %u de %s: subida %.1f ms, cola %.1f ms, cluster %.1f ms, total %.1f ms.\n",
+             resultado.job_id, c->origen, c->t_recibida - c->t_aceptada, t_inicio - c->t_recibida,
+             t_fin - t_inicio, t_fin - c->t_aceptada);
+        cerrar_conexion(c);
+    }
+}
+
+// --- Modo flujo: recibe por bloques y los reenvía a los workers mientras sigue llegando ---
+// La memoria queda acotada a los dos buffers del flujo, sin importar el tamaño del archivo.
+void handle_client_flujo(int client_socket, const char *key) {
     // 1. Recibir el tamaño del archivo
     uint64_t net_size, file_size;
-    if (recv(client_socket, &net_size, sizeof(net_size), 0) != sizeof(net_size)) {
+    if (recv_all(client_socket, &net_size, sizeof(net_size)) != 0) {
         fprintf(stderr, "[HANDLER] Error al recibir el tamaño.\n");
         close(client_socket);
         return;
     }
+    if (trama_v2_es_magia((const unsigned char *)&net_size)) {
+        const char *error = "ERROR el modo flujo solo acepta el protocolo v1 (cliente con --v1)\n";
+        send(client_socket, error, strlen(error), MSG_NOSIGNAL);
+        fprintf(stderr, "[HANDLER] Subida v2 rechazada en modo flujo.\n");
+        close(client_socket);
+        return;
+    }
     file_size = be64toh(net_size);
-    printf("[HANDLER] Se recibirán %zu bytes.\n", file_size);
+    if (file_size > max_subida) {
+        rechazar_subida(client_socket, file_size);
+        close(client_socket);
+        return;
+    }
+    INFO("[HANDLER] Se recibirán %zu bytes (modo flujo).\n", file_size);
+    double t_inicio = ahora_ms();
 
-    // 2. Alojar memoria y recibir el archivo cifrado
-    unsigned char *buffer_cifrado = malloc(file_size);
-    if (!buffer_cifrado) {
+    FlujoManager *flujo = flujo_iniciar(key);
+    if (!flujo) {
         fprintf(stderr, "[HANDLER] No se pudo alojar memoria.\n");
         close(client_socket);
         return;
     }
+    FILE *cifrado_file = fopen("archivo_recibido.cif", "wb");
 
-    if (recv_all(client_socket, buffer_cifrado, file_size) != 0) {
-        fprintf(stderr, "[HANDLER] Error al recibir los datos.\n");
-    } else {
-        printf("[HANDLER] Datos cifrados recibidos correctamente.\n");
-
-        // 3. Guardar el archivo cifrado (Requisito del proyecto)
-        FILE *cifrado_file = fopen("archivo_recibido.cif", "wb");
-        if (cifrado_file) {
-            fwrite(buffer_cifrado, 1, file_size, cifrado_file);
-            fclose(cifrado_file);
-            printf("[HANDLER] Archivo cifrado guardado en 'archivo_recibido.cif'.\n");
+    // 2. Cada recv escribe directo en el buffer del flujo; el bloque se guarda en disco
+    //    mientras el anterior viaja a su worker. Las tres fases se intercalan, así que
+    //    se acumula el tiempo de cada una.
+    double ms_subida = 0, ms_guardado = 0, ms_despacho = 0;
+    uint64_t restante = file_size;
+    while (restante > 0) {
+        size_t disponible;
+        double t0 = ahora_ms();
+        unsigned char *destino = flujo_espacio(flujo, &disponible);
+        if (disponible > restante) disponible = restante;
+        double t1 = ahora_ms();
+        ssize_t n = recv(client_socket, destino, disponible, 0);
+        double t2 = ahora_ms();
+        if (n < 1) {
+            fprintf(stderr, "[HANDLER] Error al recibir los datos (faltaron %zu bytes).\n", (size_t)restante);
+            break;
         }
+        if (cifrado_file) fwrite(destino, 1, n, cifrado_file);
+        double t3 = ahora_ms();
+        flujo_avanzar(flujo, n);
+        restante -= n;
+        ms_despacho += (t1 - t0) + (ahora_ms() - t3);
+        ms_subida += t2 - t1;
+        ms_guardado += t3 - t2;
+    }
 
-        // 4. Pasar los datos cifrados al gestor de nodos para que los procese
-        procesar_datos_distribuidos(buffer_cifrado, file_size, key);
+    if (cifrado_file) {
+        double t0 = ahora_ms();
+        fclose(cifrado_file);
+        ms_guardado += ahora_ms() - t0;
+        if (restante == 0) INFO("[HANDLER] Archivo cifrado guardado en 'archivo_recibido.cif'.\n");
     }
 
-    // 5. Limpieza
-    free(buffer_cifrado);
+    // 3. Los workers ya contaron casi todo; solo falta el último bloque y el reduce
+    ResultadoCluster resultado = { "", 0, 0 };
+    double t_cluster = ahora_ms();
+    flujo_finalizar(flujo, &resultado);
+    if (restante > 0) {
+        // Subida cortada: los workers ya terminaron su parte, pero el resultado es de
+        // datos parciales. Se descarta, igual que el archivo a medias.
+        char error[96];
+        int n = snprintf(error, sizeof(error), "ERROR subida incompleta: faltaron %llu de %llu bytes\n",
+                         (unsigned long long)restante, (unsigned long long)file_size);
+        send(client_socket, error, n, MSG_NOSIGNAL);
+        close(client_socket);
+        if (cifrado_file) unlink("archivo_recibido.cif");
+        metricas_sumar("servidor_subidas_incompletas_total", NULL, 1);
+        metricas_escribir();
+        fprintf(stderr, "[HANDLER] Trabajo %u descartado: la subida no llegó completa.\n", resultado.job_id);
+        return;
+    }
+    double t_respuesta = ahora_ms();
+    enviar_resultado(client_socket, &resultado);
+    double t_fin = ahora_ms();
+
     close(client_socket);
-    printf("[HANDLER] Cliente desconectado.\n");
+    escribir_con_brazo(&resultado);
+    registrar_fase("subida", ms_subida);
+    registrar_fase("guardado", ms_guardado);
+    registrar_fase("despacho", ms_despacho);
+    registrar_fase("cluster", t_respuesta - t_cluster);
+    registrar_fase("respuesta", t_fin - t_respuesta);
+    registrar_fase("total", t_fin - t_inicio);
+    metricas_sumar("servidor_trabajos_total", NULL, 1);
+    metricas_sumar("servidor_bytes_total", NULL, (double)(file_size - restante));
+    metricas_escribir();
+    INFO("[HANDLER] Trabajo %u terminado en %.1f ms (subida %.1f, guardado %.1f, despacho %.1f, cluster %.1f). "
+         "Cliente desconectado.\n", resultado.job_id, t_fin - t_inicio, ms_subida, ms_guardado, ms_despacho,
+         t_respuesta - t_cluster);
 }
 
 int main(int argc, char *argv[]) {
-    MPI_Init(&argc, &argv);
+    // SIGINT/SIGTERM se bloquean antes de MPI_Init: así los hilos internos de MPI
+    // también las heredan bloqueadas y rank 0 puede leerlas de un signalfd
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGINT);
+    sigaddset(&senales, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &senales, NULL);
+
+    // Los workers reparten su chunk entre hilos, pero solo el hilo principal llama a MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (provided < MPI_THREAD_FUNNELED && rank == 0) {
+        fprintf(stderr, "[SERVIDOR] Aviso: MPI no garantiza MPI_THREAD_FUNNELED.\n");
+    }
+
+    // Todos los ranks reciben los mismos argumentos, así los workers conocen el modo
+    int modo_flujo = 0;
+    int top_k = 1, contadores_aprox = 0, minusculas = 0;
+    int entradas_cache = CACHE_DEFECTO;
+    const char *ruta_metricas = RUTA_METRICAS_DEFECTO;
+    const char *ruta_brazo = NULL, *ruta_teclado = NULL;
+    int args_validos = (argc >= 3);
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--flujo") == 0) {
+            modo_flujo = 1;
+        } else if (strcmp(argv[i], "--minusculas") == 0) {
+            minusculas = 1;
+            configurar_minusculas(1);
+        } else if (strcmp(argv[i], "--hilos") == 0 && i + 1 < argc) {
+            configurar_hilos(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top_k = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--aprox") == 0 && i + 1 < argc) {
+            contadores_aprox = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            entradas_cache = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dinamico") == 0) {
+            configurar_reparto_dinamico(1);
+        } else if (strcmp(argv[i], "--max-subida") == 0 && i + 1 < argc) {
+            max_subida = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            silencioso = 1;
+            configurar_silencio(1);
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            ruta_metricas = argv[++i];
+        } else if (strcmp(argv[i], "--brazo") == 0 && i + 1 < argc) {
+            ruta_brazo = argv[++i];
+        } else if (strcmp(argv[i], "--teclado") == 0 && i + 1 < argc) {
+            ruta_teclado = argv[++i];
+        } else {
+            args_validos = 0;
+        }
+    }
+    configurar_top(top_k, contadores_aprox);
+
+    // Colectiva: crea el comunicador de workers en todos los ranks
+    inicializar_cluster();
+
     if (rank == 0){
-        if (argc != 3) {
-            fprintf(stderr, "Uso: %s <puerto> <clave>\n", argv[0]);
-            exit(EXIT_FAILURE);
+        if (!args_validos) {
+            fprintf(stderr, "Uso: %s <puerto> <clave> [--flujo] [--dinamico] [--hilos N] [--minusculas] [--max-subida BYTES] [--top K] [--aprox CONTADORES] [--cache N] [--quiet] [--metricas RUTA] [--brazo DISPOSITIVO] [--teclado RUTA]\n", argv[0]);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
 
         int port = atoi(argv[1]);
@@ -96,31 +983,113 @@ int main(int argc, char *argv[]) {
             die_with_error("Error en bind");
         }
 
-        if (listen(server_socket, 5) < 0) die_with_error("Error en listen");
+        if (listen(server_socket, SOMAXCONN) < 0) die_with_error("Error en listen");
+
+        // La consulta forma parte de la clave de la caché: otro top-k u otro plegado es otro resultado
+        HashFlujo h;
+        hash_flujo_iniciar(&h, 0);
+        hash_flujo_agregar(&h, key, strlen(key));
+        semilla_clave = hash_flujo_valor(&h);
+        int consulta[3] = { top_k, contadores_aprox, minusculas };
+        hash_flujo_iniciar(&h, 0);
+        hash_flujo_agregar(&h, consulta, sizeof(consulta));
+        firma_consulta = hash_flujo_valor(&h);
+        if (modo_flujo) entradas_cache = 0; // En modo flujo los workers cuentan mientras llega la subida
+        if (cache_abrir(&cache, RUTA_CACHE, entradas_cache) != 0) die_with_error("Error al reservar la caché");
+        metricas_iniciar(ruta_metricas);
+
+        // Brazo: teclado (QWERTY si no se indica otro) y, con --brazo, el dispositivo
+        teclado_qwerty(&teclado);
+        if (ruta_teclado && teclado_cargar(&teclado, ruta_teclado) != 0) {
+            fprintf(stderr, "[SERVIDOR] Teclado '%s' inválido.\n", ruta_teclado);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        posicion_brazo = teclado_inicio(&teclado);
+        pthread_t hilo_del_brazo;
+        if (ruta_brazo) {
+            fd_brazo = Biblioteca_Open(ruta_brazo);
+            if (fd_brazo < 0) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            if (pthread_create(&hilo_del_brazo, NULL, hilo_brazo, NULL) != 0) {
+                die_with_error("Error al crear el hilo del brazo");
+            }
+        }
+
+        // SIGINT/SIGTERM llegan por un signalfd para apagar en orden
+        int senal_fd = signalfd(-1, &senales, SFD_CLOEXEC);
+        if (senal_fd < 0) die_with_error("Error en signalfd");
 
         printf("[SERVIDOR] Esperando conexiones en el puerto %d...\n", port);
 
-        for (;;) {
-            struct sockaddr_in client_addr;
-            socklen_t addr_len = sizeof(client_addr);
-            int client_socket = accept(server_socket, (struct sockaddr *)&client_addr, &addr_len);
-            if (client_socket < 0) {
-                perror("Error en accept, continuando...");
-                continue;
+        if (!modo_flujo) {
+            // Front end epoll en otro hilo; este hilo despacha los trabajos al cluster
+            fcntl(server_socket, F_SETFL, fcntl(server_socket, F_GETFL) | O_NONBLOCK);
+            ArgsEpoll args = { server_socket, senal_fd };
+            pthread_t hilo_epoll;
+            if (pthread_create(&hilo_epoll, NULL, bucle_epoll, &args) != 0) {
+                die_with_error("Error al crear el hilo epoll");
             }
+            despachar_trabajos(key);
+            pthread_join(hilo_epoll, NULL);
+        } else {
+            // Modo flujo: el cluster recibe mientras llega la subida, un cliente a la vez
+            struct pollfd fds[2] = {
+                { .fd = server_socket, .events = POLLIN },
+                { .fd = senal_fd, .events = POLLIN },
+            };
+            for (;;) {
+                if (poll(fds, 2, -1) < 0) {
+                    if (errno == EINTR) continue;
+                    die_with_error("Error en poll");
+                }
+                if (fds[1].revents & POLLIN) {
+                    struct signalfd_siginfo info;
+                    if (read(senal_fd, &info, sizeof(info)) == sizeof(info)) {
+                        printf("\n[SERVIDOR] Señal %u recibida: no se aceptan más clientes.\n", info.ssi_signo);
+                    }
+                    break;
+                }
+                if (!(fds[0].revents & POLLIN)) continue;
+
+                struct sockaddr_in client_addr;
+                socklen_t addr_len = sizeof(client_addr);
+                int client_socket = accept(server_socket, (struct sockaddr *)&client_addr, &addr_len);
+                if (client_socket < 0) {
+                    perror("Error en accept, continuando...");
+                    continue;
+                }
+
+                char client_ip[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+                INFO("\n[SERVIDOR] Petición de conexión de %s:%d. Pasando al handler...\n", client_ip, ntohs(client_addr.sin_port));
 
-            char client_ip[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
-            printf("\n[SERVIDOR] Petición de conexión de %s:%d. Pasando al handler...\n", client_ip, ntohs(client_addr.sin_port));
+                handle_client_flujo(client_socket, key);
 
-            handle_client(client_socket, key);
-            
-            printf("[SERVIDOR] Esperando nueva conexión...\n");
+                INFO("[SERVIDOR] Esperando nueva conexión...\n");
+            }
+            apagar_workers();
+        }
+        if (cache.capacidad > 0) {
+            printf("[SERVIDOR] Caché: %lu aciertos, %lu fallos, %d resultados guardados.\n",
+                   cache.aciertos, cache.fallos, cache.usadas);
+        }
+        cache_cerrar(&cache);
+        if (fd_brazo >= 0) {
+            pthread_mutex_lock(&brazo_mutex);
+            brazo_apagar = 1;
+            pthread_cond_signal(&brazo_cond);
+            pthread_mutex_unlock(&brazo_mutex);
+            pthread_join(hilo_del_brazo, NULL);
+            Biblioteca_Close(fd_brazo);
         }
-    } else{
-        procesar_datos_distribuidos(NULL, 0, NULL);
+        close(senal_fd);
+        close(server_socket);
+        printf("[SERVIDOR] Apagado completo.\n");
+    } else {
+        // En los workers las señales conservan su efecto normal (mpirun las usa para abortar)
+        pthread_sigmask(SIG_UNBLOCK, &senales, NULL);
+        // Los workers atienden un trabajo tras otro hasta que rank 0 los apaga
+        servicio_worker();
     }
-    close(server_socket);
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
@@ -1,25 +1,27 @@
 #!/bin/bash
 # Este script compila todos los archivos .c del servidor y lo ejecuta.
 
-if [ "$#" -ne 2 ]; then
-    echo "Uso: ./compilar_servidor.sh <puerto> <clave>"
+if [ "$#" -lt 2 ]; then
+    echo "Uso: ./compilar_servidor.sh <puerto> <clave> [--flujo] [--dinamico] [--hilos N] [--minusculas] [--max-subida BYTES] [--top K] [--aprox CONTADORES] [--cache N] [--quiet] [--metricas RUTA] [--brazo DISPOSITIVO] [--teclado RUTA]"
     exit 1
 fi
 
 PUERTO=$1
 CLAVE=$2
+shift 2
 
-echo "Compilando servidor_final.c y node_manager.c..."
+echo "Compilando servidor.c y los módulos del cluster..."
 
 # Compilar todos los archivos .c juntos para crear un único ejecutable
-gcc -Wall -g -o servidor servidor.c node_manager.c
+# El planificador del brazo usa la biblioteca del driver (../Biblioteca)
+mpicc -Wall -g -I../Biblioteca -o servidor servidor.c node_manager.c word_table.c xor_cipher.c tokenizer.c space_saving.c hash_contenido.c cache_resultados.c metricas.c planificador.c ../Biblioteca/biblioteca.c -pthread -lm
 
 if [ $? -eq 0 ]; then
     echo "¡Compilación exitosa!"
     echo "-------------------------------------"
     echo "Iniciando servidor en el puerto $PUERTO..."
     
-    ./servidor "$PUERTO" "$CLAVE"
+    ./servidor "$PUERTO" "$CLAVE" "$@"
 else
     echo "¡Error de compilación!"
 fi
\ No newline at end of file
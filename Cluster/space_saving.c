@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+#include "space_saving.h"
+
+// --- Índice hash -> posición en el heap (sondeo lineal, borrado por corrimiento) ---
+
+static size_t guardado(size_t len) {
+    return len < SS_MAX_PALABRA - 1 ? len : SS_MAX_PALABRA - 1;
+}
+
+static int es_palabra(const SSContador *c, const char *palabra, size_t len, uint64_t hash) {
+    return c->hash == hash && c->len == guardado(len) && memcmp(c->palabra, palabra, c->len) == 0;
+}
+
+// Casilla del índice que tiene la palabra, o la casilla vacía donde iría
+static size_t casilla_de(const SpaceSaving *ss, const char *palabra, size_t len, uint64_t hash) {
+    size_t mask = ss->indice_cap - 1;
+    size_t i = hash & mask;
+    while (ss->indice[i] >= 0 && !es_palabra(&ss->heap[ss->indice[i]], palabra, len, hash)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// Casilla del índice que apunta a la posición 'pos' del heap
+static size_t casilla_de_pos(const SpaceSaving *ss, size_t pos) {
+    size_t mask = ss->indice_cap - 1;
+    size_t i = ss->heap[pos].hash & mask;
+    while (ss->indice[i] != (int32_t)pos) i = (i + 1) & mask;
+    return i;
+}
+
+static void indice_borrar(SpaceSaving *ss, size_t i) {
+    size_t mask = ss->indice_cap - 1;
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (ss->indice[j] < 0) break;
+        size_t ideal = ss->heap[ss->indice[j]].hash & mask;
+        // Si 'ideal' cae en (i, j] (circular), la entrada j no puede subir a i
+        int queda = i <= j ? (i < ideal && ideal <= j) : (i < ideal || ideal <= j);
+        if (queda) continue;
+        ss->indice[i] = ss->indice[j];
+        i = j;
+    }
+    ss->indice[i] = -1;
+}
+
+// --- Min-heap por count; cada intercambio actualiza el índice ---
+
+static void intercambiar(SpaceSaving *ss, size_t a, size_t b) {
+    size_t ca = casilla_de_pos(ss, a);
+    size_t cb = casilla_de_pos(ss, b);
+    SSContador tmp = ss->heap[a];
+    ss->heap[a] = ss->heap[b];
+    ss->heap[b] = tmp;
+    ss->indice[ca] = (int32_t)b;
+    ss->indice[cb] = (int32_t)a;
+}
+
+static void subir(SpaceSaving *ss, size_t i) {
+    while (i > 0) {
+        size_t padre = (i - 1) / 2;
+        if (ss->heap[padre].count <= ss->heap[i].count) break;
+        intercambiar(ss, padre, i);
+        i = padre;
+    }
+}
+
+static void bajar(SpaceSaving *ss, size_t i) {
+    for (;;) {
+        size_t menor = i;
+        size_t izq = 2 * i + 1, der = 2 * i + 2;
+        if (izq < ss->usados && ss->heap[izq].count < ss->heap[menor].count) menor = izq;
+        if (der < ss->usados && ss->heap[der].count < ss->heap[menor].count) menor = der;
+        if (menor == i) return;
+        intercambiar(ss, i, menor);
+        i = menor;
+    }
+}
+
+static void escribir(SSContador *c, const char *palabra, size_t len, uint64_t hash, int64_t count, int64_t error) {
+    c->hash = hash;
+    c->count = count;
+    c->error = error;
+    c->len = (uint32_t)guardado(len);
+    memcpy(c->palabra, palabra, c->len);
+    c->palabra[c->len] = '\0';
+}
+
+int space_saving_init(SpaceSaving *ss, size_t capacidad) {
+    if (capacidad == 0) capacidad = 1;
+    size_t cap = 16;
+    while (cap < 2 * capacidad) cap <<= 1;
+    ss->heap = malloc(capacidad * sizeof(SSContador));
+    ss->indice = malloc(cap * sizeof(int32_t));
+    if (!ss->heap || !ss->indice) {
+        free(ss->heap);
+        free(ss->indice);
+        return -1;
+    }
+    memset(ss->indice, 0xff, cap * sizeof(int32_t)); // -1 en todas las casillas
+    ss->capacidad = capacidad;
+    ss->usados = 0;
+    ss->indice_cap = cap;
+    ss->total = 0;
+    return 0;
+}
+
+void space_saving_add(SpaceSaving *ss, const char *palabra, size_t len, uint64_t hash, int64_t n) {
+    ss->total += n;
+    size_t casilla = casilla_de(ss, palabra, len, hash);
+    if (ss->indice[casilla] >= 0) {
+        size_t pos = ss->indice[casilla];
+        ss->heap[pos].count += n;
+        bajar(ss, pos);
+        return;
+    }
+
+    if (ss->usados < ss->capacidad) {
+        size_t pos = ss->usados++;
+        escribir(&ss->heap[pos], palabra, len, hash, n, 0);
+        ss->indice[casilla] = (int32_t)pos;
+        subir(ss, pos);
+        return;
+    }
+
+    // Lleno: la palabra nueva reemplaza al mínimo y hereda su count como error
+    int64_t minimo = ss->heap[0].count;
+    indice_borrar(ss, casilla_de_pos(ss, 0));
+    escribir(&ss->heap[0], palabra, len, hash, minimo + n, minimo);
+    ss->indice[casilla_de(ss, palabra, len, hash)] = 0;
+    bajar(ss, 0);
+}
+
+int64_t space_saving_minimo(const SpaceSaving *ss) {
+    return ss->usados == ss->capacidad ? ss->heap[0].count : 0;
+}
+
+// Orden de salida: mayor count primero; en empate, la palabra menor
+static int comparar_desc(const void *a, const void *b) {
+    const SSContador *x = a, *y = b;
+    if (x->count != y->count) return x->count > y->count ? -1 : 1;
+    return strcmp(x->palabra, y->palabra);
+}
+
+int space_saving_cargar(SpaceSaving *ss, const SSContador *contadores, size_t n, int64_t total) {
+    SSContador *orden = NULL;
+    if (n > ss->capacidad) {
+        orden = malloc(n * sizeof(SSContador));
+        if (!orden) return -1;
+        memcpy(orden, contadores, n * sizeof(SSContador));
+        qsort(orden, n, sizeof(SSContador), comparar_desc);
+        contadores = orden;
+        n = ss->capacidad;
+    }
+
+    memset(ss->indice, 0xff, ss->indice_cap * sizeof(int32_t));
+    memcpy(ss->heap, contadores, n * sizeof(SSContador));
+    ss->usados = n;
+    ss->total = total;
+    for (size_t i = 0; i < n; ++i) {
+        const SSContador *c = &ss->heap[i];
+        ss->indice[casilla_de(ss, c->palabra, c->len, c->hash)] = (int32_t)i;
+    }
+    for (size_t i = n / 2; i-- > 0;) bajar(ss, i);
+    free(orden);
+    return 0;
+}
+
+int space_saving_fundir(SpaceSaving *ss, const SpaceSaving *otro) {
+    int64_t min_ss = space_saving_minimo(ss);
+    int64_t min_otro = space_saving_minimo(otro);
+    SSContador *union_ = malloc((ss->usados + otro->usados) * sizeof(SSContador) + 1);
+    if (!union_) return -1;
+
+    size_t n = 0;
+    for (size_t i = 0; i < ss->usados; ++i) {
+        SSContador c = ss->heap[i];
+        int32_t pos = otro->indice[casilla_de(otro, c.palabra, c.len, c.hash)];
+        c.count += pos >= 0 ? otro->heap[pos].count : min_otro;
+        c.error += pos >= 0 ? otro->heap[pos].error : min_otro;
+        union_[n++] = c;
+    }
+    for (size_t i = 0; i < otro->usados; ++i) {
+        SSContador c = otro->heap[i];
+        if (ss->indice[casilla_de(ss, c.palabra, c.len, c.hash)] >= 0) continue; // Ya sumada
+        c.count += min_ss;
+        c.error += min_ss;
+        union_[n++] = c;
+    }
+
+    int rc = space_saving_cargar(ss, union_, n, ss->total + otro->total);
+    free(union_);
+    return rc;
+}
+
+size_t space_saving_top(const SpaceSaving *ss, SSContador *salida, size_t k) {
+    if (ss->usados == 0 || k == 0) return 0;
+    SSContador *orden = malloc(ss->usados * sizeof(SSContador));
+    if (!orden) return 0;
+    memcpy(orden, ss->heap, ss->usados * sizeof(SSContador));
+    qsort(orden, ss->usados, sizeof(SSContador), comparar_desc);
+    if (k > ss->usados) k = ss->usados;
+    memcpy(salida, orden, k * sizeof(SSContador));
+    free(orden);
+    return k;
+}
+
+void space_saving_free(SpaceSaving *ss) {
+    free(ss->heap);
+    free(ss->indice);
+    ss->heap = NULL;
+    ss->indice = NULL;
+    ss->capacidad = ss->usados = 0;
+}
@@ -0,0 +1,81 @@
+#ifndef SPACE_SAVING_H
+#define SPACE_SAVING_H
+
+#include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint64_t, int64_t
+
+#define SS_MAX_PALABRA 100 // Bytes guardados por palabra (incluye el '\0'), igual que MAX_PALABRA
+
+/**
+ * @brief Contador de Space-Saving. La frecuencia real de la palabra está en
+ * [count - error, count]. Las palabras más largas se guardan truncadas; la
+ * identidad es el hash de la palabra completa.
+ */
+typedef struct {
+    uint64_t hash;
+    int64_t count;
+    int64_t error;
+    uint32_t len;       // Bytes guardados en 'palabra'
+    char palabra[SS_MAX_PALABRA];
+} SSContador;
+
+/**
+ * @brief Resumen de heavy hitters con memoria fija (Metwally et al., Space-Saving).
+ * Guarda a lo sumo 'capacidad' contadores en un min-heap por count; una palabra
+ * nueva con el resumen lleno reemplaza al mínimo y hereda su count como error.
+ * Toda palabra con frecuencia mayor que total / capacidad está en el resumen.
+ */
+typedef struct {
+    SSContador *heap;   // Min-heap por count, 'usados' elementos
+    size_t capacidad;
+    size_t usados;
+    int32_t *indice;    // Hash -> posición en el heap (-1 = vacío), sondeo lineal
+    size_t indice_cap;  // Potencia de 2, al menos 2 * capacidad
+    int64_t total;      // Apariciones procesadas (N)
+} SpaceSaving;
+
+/**
+ * @brief Reserva un resumen de 'capacidad' contadores. La memoria no cambia después.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int space_saving_init(SpaceSaving *ss, size_t capacidad);
+
+/**
+ * @brief Suma n apariciones de la palabra (len bytes) con su hash ya calculado.
+ */
+void space_saving_add(SpaceSaving *ss, const char *palabra, size_t len, uint64_t hash, int64_t n);
+
+/**
+ * @brief Count que se le supone a una palabra ausente: el mínimo si el resumen
+ * está lleno, 0 si no (entonces ninguna palabra quedó afuera).
+ */
+int64_t space_saving_minimo(const SpaceSaving *ss);
+
+/**
+ * @brief Funde 'otro' en 'ss' (resúmenes mergeables, Agarwal et al.): cada palabra
+ * suma su count en ambos, usando space_saving_minimo() del resumen donde falta,
+ * y quedan los 'capacidad' mayores. Las cotas de error se suman igual.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int space_saving_fundir(SpaceSaving *ss, const SpaceSaving *otro);
+
+/**
+ * @brief Copia en 'salida' hasta k contadores de mayor a menor count (en empate,
+ * la palabra menor en orden lexicográfico).
+ * @return Cantidad copiada.
+ */
+size_t space_saving_top(const SpaceSaving *ss, SSContador *salida, size_t k);
+
+/**
+ * @brief Reemplaza el contenido con 'n' contadores (p. ej. recibidos de otro nodo).
+ * Si sobran, quedan los de mayor count.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int space_saving_cargar(SpaceSaving *ss, const SSContador *contadores, size_t n, int64_t total);
+
+/**
+ * @brief Libera el resumen.
+ */
+void space_saving_free(SpaceSaving *ss);
+
+#endif // SPACE_SAVING_H
@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tokenizer.h"
+
+#define PLEGADO_PILA 256 // Palabras plegadas de hasta este largo no tocan el heap
+
+void tokenizer_init(Tokenizer *tk, int plegar_mayusculas) {
+    for (int c = 0; c < 256; ++c) {
+        tk->mapa[c] = (unsigned char)c;
+        if (plegar_mayusculas && c >= 'A' && c <= 'Z') tk->mapa[c] = (unsigned char)(c - 'A' + 'a');
+    }
+    tk->mapa[0] = 0;
+    for (const char *d = TOKEN_DELIMITADORES; *d; ++d) tk->mapa[(unsigned char)*d] = 0;
+    tk->plegar = plegar_mayusculas;
+}
+
+int tokenizar(const Tokenizer *tk, const unsigned char *texto, size_t len, TokenFn fn, void *ctx) {
+    const unsigned char *mapa = tk->mapa;
+    char pila[PLEGADO_PILA];
+    char *plegado = pila;
+    size_t capacidad = sizeof(pila);
+    int rc = 0;
+    size_t i = 0;
+
+    while (i < len && rc == 0) {
+        while (i < len && mapa[texto[i]] == 0) ++i;
+        if (i == len) break;
+
+        size_t inicio = i;
+        uint64_t h = WORD_HASH_OFFSET;
+        if (!tk->plegar) {
+            // Sin plegado la palabra se entrega directo desde el buffer original
+            unsigned char c;
+            while (i < len && (c = mapa[texto[i]]) != 0) {
+                h = (h ^ c) * WORD_HASH_PRIME;
+                ++i;
+            }
+            rc = fn(ctx, (const char *)texto + inicio, i - inicio, h ? h : 1);
+        } else {
+            // Con plegado se escribe la versión en minúsculas en el mismo recorrido
+            size_t n = 0;
+            unsigned char c;
+            while (i < len && (c = mapa[texto[i]]) != 0) {
+                if (n == capacidad) {
+                    size_t nueva = capacidad * 2;
+                    char *mas = plegado == pila ? malloc(nueva) : realloc(plegado, nueva);
+                    if (!mas) {
+                        rc = -1;
+                        break;
+                    }
+                    if (plegado == pila) memcpy(mas, pila, n);
+                    plegado = mas;
+                    capacidad = nueva;
+                }
+                plegado[n++] = (char)c;
+                h = (h ^ c) * WORD_HASH_PRIME;
+                ++i;
+            }
+            if (rc == 0) rc = fn(ctx, plegado, n, h ? h : 1);
+        }
+    }
+
+    if (plegado != pila) free(plegado);
+    return rc;
+}
+
+static int sumar_en_tabla(void *ctx, const char *palabra, size_t len, uint64_t hash) {
+    return word_table_add_hashed((WordTable *)ctx, palabra, len, hash, 1);
+}
+
+int tokenizar_en_tabla(const Tokenizer *tk, const unsigned char *texto, size_t len, WordTable *tabla) {
+    return tokenizar(tk, texto, len, sumar_en_tabla, tabla) == 0 ? 0 : -1;
+}
@@ -0,0 +1,54 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint64_t
+#include "word_table.h"
+
+// Delimitadores de palabra (los mismos que usaba strtok); '\0' también separa
+#define TOKEN_DELIMITADORES " \t\n\r,.;:!?\"()[]{}"
+
+/**
+ * @brief Tabla de clases de 256 entradas, se arma una sola vez.
+ * mapa[c] == 0 si c es delimitador; si no, el byte que se guarda para c
+ * (c mismo, o su minúscula ASCII si se pliegan mayúsculas).
+ */
+typedef struct {
+    unsigned char mapa[256];
+    int plegar;
+} Tokenizer;
+
+/**
+ * @brief Recibe cada palabra encontrada con su hash (el mismo que word_hash).
+ * La palabra no termina en '\0' y solo es válida durante la llamada.
+ * @return 0 para seguir, distinto de 0 para detener el recorrido.
+ */
+typedef int (*TokenFn)(void *ctx, const char *palabra, size_t len, uint64_t hash);
+
+/**
+ * @brief Arma la tabla de clases.
+ * @param plegar_mayusculas Si no es 0, 'A'-'Z' se cuentan como 'a'-'z'.
+ */
+void tokenizer_init(Tokenizer *tk, int plegar_mayusculas);
+
+/**
+ * @brief Indica si el byte es delimitador de palabra.
+ */
+static inline int tokenizer_es_delimitador(const Tokenizer *tk, unsigned char c) {
+    return tk->mapa[c] == 0;
+}
+
+/**
+ * @brief Recorre el texto una sola vez, sin copiarlo ni modificarlo, y entrega
+ * cada palabra con su hash (y plegada, si corresponde) a 'fn'.
+ * @return 0, o el primer valor distinto de 0 que devolvió 'fn' (o -1 sin memoria).
+ */
+int tokenizar(const Tokenizer *tk, const unsigned char *texto, size_t len, TokenFn fn, void *ctx);
+
+/**
+ * @brief Atajo de tokenizar() que suma cada palabra en una WordTable.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int tokenizar_en_tabla(const Tokenizer *tk, const unsigned char *texto, size_t len, WordTable *tabla);
+
+#endif // TOKENIZER_H
@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <string.h>
+#include "word_table.h"
+
+#define ARENA_BLOQUE_MIN (64 * 1024)
+
+// --- Arena: reserva lineal dentro del bloque actual, nuevo bloque si no cabe ---
+static char *arena_alloc(WordArena *arena, size_t n) {
+    ArenaBloque *b = arena->actual;
+    if (!b || b->capacidad - b->usado < n) {
+        size_t cap = n > ARENA_BLOQUE_MIN ? n : ARENA_BLOQUE_MIN;
+        ArenaBloque *nuevo = malloc(sizeof(ArenaBloque) + cap);
+        if (!nuevo) return NULL;
+        nuevo->sig = b;
+        nuevo->usado = 0;
+        nuevo->capacidad = cap;
+        arena->actual = nuevo;
+        b = nuevo;
+    }
+    char *p = b->datos + b->usado;
+    b->usado += n;
+    return p;
+}
+
+static void arena_free(WordArena *arena) {
+    ArenaBloque *b = arena->actual;
+    while (b) {
+        ArenaBloque *sig = b->sig;
+        free(b);
+        b = sig;
+    }
+    arena->actual = NULL;
+}
+
+uint64_t word_hash(const char *word, size_t len) {
+    uint64_t h = WORD_HASH_OFFSET;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)word[i];
+        h *= WORD_HASH_PRIME;
+    }
+    return h ? h : 1;
+}
+
+int word_table_init(WordTable *table, size_t capacidad_inicial) {
+    size_t cap = 16;
+    while (cap < capacidad_inicial) cap <<= 1;
+    table->slots = calloc(cap, sizeof(WordSlot));
+    if (!table->slots) return -1;
+    table->capacity = cap;
+    table->size = 0;
+    table->arena.actual = NULL;
+    return 0;
+}
+
+// --- Duplica la capacidad reubicando con el hash guardado (sin recalcularlo) ---
+static int word_table_grow(WordTable *table) {
+    size_t new_cap = table->capacity * 2;
+    WordSlot *nuevos = calloc(new_cap, sizeof(WordSlot));
+    if (!nuevos) return -1;
+    size_t mask = new_cap - 1;
+    for (size_t i = 0; i < table->capacity; ++i) {
+        WordSlot *s = &table->slots[i];
+        if (s->hash == 0) continue;
+        size_t j = s->hash & mask;
+        while (nuevos[j].hash != 0) j = (j + 1) & mask;
+        nuevos[j] = *s;
+    }
+    free(table->slots);
+    table->slots = nuevos;
+    table->capacity = new_cap;
+    return 0;
+}
+
+int word_table_add_hashed(WordTable *table, const char *word, size_t len, uint64_t hash, int n) {
+    size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+    for (;;) {
+        WordSlot *s = &table->slots[i];
+        if (s->hash == 0) break;
+        if (s->hash == hash && s->len == len && memcmp(s->word, word, len) == 0) {
+            s->count += n;
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Palabra nueva: mantener el factor de carga por debajo de 1/2
+    if ((table->size + 1) * 2 > table->capacity) {
+        if (word_table_grow(table) != 0) return -1;
+        mask = table->capacity - 1;
+        i = hash & mask;
+        while (table->slots[i].hash != 0) i = (i + 1) & mask;
+    }
+
+    char *copia = arena_alloc(&table->arena, len + 1);
+    if (!copia) return -1;
+    memcpy(copia, word, len);
+    copia[len] = '\0';
+
+    WordSlot *s = &table->slots[i];
+    s->hash = hash;
+    s->word = copia;
+    s->len = (uint32_t)len;
+    s->count = n;
+    table->size++;
+    return 0;
+}
+
+int word_table_add(WordTable *table, const char *word, size_t len, int n) {
+    return word_table_add_hashed(table, word, len, word_hash(word, len), n);
+}
+
+const WordSlot *word_table_best(const WordTable *table) {
+    const WordSlot *best = NULL;
+    for (size_t i = 0; i < table->capacity; ++i) {
+        const WordSlot *s = &table->slots[i];
+        if (s->hash == 0) continue;
+        if (!best || s->count > best->count ||
+            (s->count == best->count && strcmp(s->word, best->word) < 0)) {
+            best = s;
+        }
+    }
+    return best;
+}
+
+// 1 si 'a' va antes que 'b' en el ranking
+static int mejor_que(const WordSlot *a, const WordSlot *b) {
+    return a->count > b->count || (a->count == b->count && strcmp(a->word, b->word) < 0);
+}
+
+// --- Heap de mínimos (la peor del top en la raíz) sobre punteros a casillas ---
+static void top_bajar(const WordSlot **heap, size_t n, size_t i) {
+    for (;;) {
+        size_t peor = i;
+        size_t izq = 2 * i + 1, der = 2 * i + 2;
+        if (izq < n && mejor_que(heap[peor], heap[izq])) peor = izq;
+        if (der < n && mejor_que(heap[peor], heap[der])) peor = der;
+        if (peor == i) return;
+        const WordSlot *tmp = heap[i];
+        heap[i] = heap[peor];
+        heap[peor] = tmp;
+        i = peor;
+    }
+}
+
+size_t word_table_top(const WordTable *table, const WordSlot **salida, size_t k) {
+    size_t n = 0;
+    for (size_t i = 0; i < table->capacity && k > 0; ++i) {
+        const WordSlot *s = &table->slots[i];
+        if (s->hash == 0) continue;
+        if (n < k) {
+            salida[n++] = s;
+            if (n == k) {
+                for (size_t j = k / 2; j-- > 0;) top_bajar(salida, k, j);
+            }
+        } else if (mejor_que(s, salida[0])) {
+            salida[0] = s;
+            top_bajar(salida, k, 0);
+        }
+    }
+    if (n < k) {
+        for (size_t j = n / 2; j-- > 0;) top_bajar(salida, n, j);
+    }
+    // Sacar la raíz (la peor) al final en cada paso deja el arreglo de mejor a peor
+    for (size_t fin = n; fin > 1; --fin) {
+        const WordSlot *tmp = salida[0];
+        salida[0] = salida[fin - 1];
+        salida[fin - 1] = tmp;
+        top_bajar(salida, fin - 1, 0);
+    }
+    return n;
+}
+
+void word_table_free(WordTable *table) {
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->size = 0;
+    arena_free(&table->arena);
+}
@@ -0,0 +1,87 @@
+#ifndef WORD_TABLE_H
+#define WORD_TABLE_H
+
+#include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint64_t
+
+// Constantes de FNV-1a, públicas para que el tokenizador calcule el mismo hash al recorrer
+#define WORD_HASH_OFFSET 0xcbf29ce484222325ULL
+#define WORD_HASH_PRIME  0x100000001b3ULL
+
+/**
+ * @brief Arena de bytes tipo "bump": las palabras se copian una detrás de otra
+ * en bloques grandes y se liberan todas juntas con una sola llamada.
+ */
+typedef struct ArenaBloque {
+    struct ArenaBloque *sig;
+    size_t usado;
+    size_t capacidad;
+    char datos[];
+} ArenaBloque;
+
+typedef struct {
+    ArenaBloque *actual;
+} WordArena;
+
+/**
+ * @brief Casilla de la tabla. El hash se guarda junto a la palabra para no
+ * recalcularlo al comparar ni al crecer. hash == 0 marca una casilla vacía.
+ */
+typedef struct {
+    uint64_t hash;
+    const char *word;   // Terminada en '\0', vive en la arena
+    uint32_t len;
+    int count;
+} WordSlot;
+
+/**
+ * @brief Tabla hash de direccionamiento abierto (sondeo lineal) para contar palabras.
+ */
+typedef struct {
+    WordSlot *slots;
+    size_t capacity;    // Siempre potencia de 2
+    size_t size;
+    WordArena arena;
+} WordTable;
+
+/**
+ * @brief Hash FNV-1a de 64 bits. Es determinista entre nodos, nunca devuelve 0.
+ */
+uint64_t word_hash(const char *word, size_t len);
+
+/**
+ * @brief Inicializa la tabla. La capacidad se redondea a potencia de 2.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int word_table_init(WordTable *table, size_t capacidad_inicial);
+
+/**
+ * @brief Suma n apariciones de la palabra (len bytes, no necesita '\0').
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int word_table_add(WordTable *table, const char *word, size_t len, int n);
+
+/**
+ * @brief Igual que word_table_add pero con el hash ya calculado por el llamador.
+ */
+int word_table_add_hashed(WordTable *table, const char *word, size_t len, uint64_t hash, int n);
+
+/**
+ * @brief Devuelve la casilla con más apariciones (en empate, la palabra menor
+ * en orden lexicográfico) o NULL si la tabla está vacía.
+ */
+const WordSlot *word_table_best(const WordTable *table);
+
+/**
+ * @brief Copia en 'salida' hasta k casillas de mayor a menor count (en empate,
+ * la palabra menor en orden lexicográfico). Usa un heap de k elementos.
+ * @return Cantidad copiada.
+ */
+size_t word_table_top(const WordTable *table, const WordSlot **salida, size_t k);
+
+/**
+ * @brief Libera las casillas y toda la arena de una sola vez.
+ */
+void word_table_free(WordTable *table);
+
+#endif // WORD_TABLE_H
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+#include "xor_cipher.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define XOR_X86 1
+#endif
+
+#define ANCHO_VECTOR 32
+
+// Cada kernel recorre el bloque expandido desde 'pos' (< periodo). Como el bloque
+// tiene 32 bytes extra después del periodo, una carga de 32 bytes nunca se sale.
+
+// --- Camino escalar (y cola de los caminos vectoriales) ---
+static void xor_escalar(const unsigned char *bloque, size_t periodo, unsigned char *data, size_t len, size_t pos) {
+    for (size_t i = 0; i < len; ++i) {
+        data[i] ^= bloque[pos];
+        if (++pos == periodo) pos = 0;
+    }
+}
+
+#ifdef XOR_X86
+__attribute__((target("sse2")))
+static void xor_sse2(const unsigned char *bloque, size_t periodo, unsigned char *data, size_t len, size_t pos) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i k = _mm_loadu_si128((const __m128i *)(bloque + pos));
+        __m128i d = _mm_loadu_si128((const __m128i *)(data + i));
+        _mm_storeu_si128((__m128i *)(data + i), _mm_xor_si128(d, k));
+        pos += 16;
+        if (pos >= periodo) pos -= periodo;
+    }
+    xor_escalar(bloque, periodo, data + i, len - i, pos);
+}
+
+__attribute__((target("avx2")))
+static void xor_avx2(const unsigned char *bloque, size_t periodo, unsigned char *data, size_t len, size_t pos) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i k = _mm256_loadu_si256((const __m256i *)(bloque + pos));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(data + i));
+        _mm256_storeu_si256((__m256i *)(data + i), _mm256_xor_si256(d, k));
+        pos += 32;
+        if (pos >= periodo) pos -= periodo;
+    }
+    xor_sse2(bloque, periodo, data + i, len - i, pos);
+}
+#endif
+
+static size_t mcd(size_t a, size_t b) {
+    while (b) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+const char *xor_cipher_impl(void) {
+#ifdef XOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+    if (__builtin_cpu_supports("sse2")) return "sse2";
+#endif
+    return "escalar";
+}
+
+int xor_cipher_init(XorCipher *cipher, const char *key, size_t key_len) {
+    cipher->key_len = key_len;
+    cipher->bloque = NULL;
+    cipher->periodo = 0;
+    cipher->kernel = xor_escalar;
+    if (key_len == 0) return 0;
+
+    size_t periodo = key_len / mcd(key_len, ANCHO_VECTOR) * ANCHO_VECTOR;
+    size_t total = periodo + ANCHO_VECTOR; // Ya es múltiplo de 32 (requisito de aligned_alloc)
+    unsigned char *bloque = aligned_alloc(ANCHO_VECTOR, total);
+    if (!bloque) return -1;
+    for (size_t i = 0; i < total; ++i) bloque[i] = (unsigned char)key[i % key_len];
+
+    cipher->bloque = bloque;
+    cipher->periodo = periodo;
+#ifdef XOR_X86
+    const char *impl = xor_cipher_impl();
+    if (strcmp(impl, "avx2") == 0) cipher->kernel = xor_avx2;
+    else if (strcmp(impl, "sse2") == 0) cipher->kernel = xor_sse2;
+#endif
+    return 0;
+}
+
+void xor_cipher_free(XorCipher *cipher) {
+    free(cipher->bloque);
+    cipher->bloque = NULL;
+}
+
+void xor_at(const XorCipher *cipher, unsigned char *data, size_t len, uint64_t offset) {
+    if (cipher->key_len == 0 || len == 0) return;
+    cipher->kernel(cipher->bloque, cipher->periodo, data, len, (size_t)(offset % cipher->periodo));
+}
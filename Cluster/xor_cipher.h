@@ -0,0 +1,43 @@
+#ifndef XOR_CIPHER_H
+#define XOR_CIPHER_H
+
+#include <stddef.h> // Para size_t
+#include <stdint.h> // Para uint64_t
+
+/**
+ * @brief Clave XOR expandida. La clave se repite en un bloque cuyo largo es
+ * múltiplo del largo de la clave y del ancho vectorial (32 bytes), así cada
+ * carga vectorial toma la porción correcta del flujo de clave sin usar '%'.
+ */
+typedef struct {
+    unsigned char *bloque;  // periodo + 32 bytes, alineado a 32
+    size_t periodo;         // mcm(key_len, 32)
+    size_t key_len;
+    // Kernel elegido en xor_cipher_init según la CPU
+    void (*kernel)(const unsigned char *bloque, size_t periodo, unsigned char *data, size_t len, size_t pos);
+} XorCipher;
+
+/**
+ * @brief Expande la clave. Una clave vacía deja los datos sin cambios.
+ * @return 0 en éxito, -1 si no hay memoria.
+ */
+int xor_cipher_init(XorCipher *cipher, const char *key, size_t key_len);
+
+/**
+ * @brief Libera el bloque expandido.
+ */
+void xor_cipher_free(XorCipher *cipher);
+
+/**
+ * @brief Cifra/descifra en el lugar 'len' bytes que empiezan en la posición
+ * 'offset' del archivo completo. Usa AVX2 o SSE2 si la CPU los soporta
+ * (se elige en tiempo de ejecución) y si no, un camino escalar.
+ */
+void xor_at(const XorCipher *cipher, unsigned char *data, size_t len, uint64_t offset);
+
+/**
+ * @brief Nombre de la implementación elegida ("avx2", "sse2" o "escalar").
+ */
+const char *xor_cipher_impl(void);
+
+#endif // XOR_CIPHER_H
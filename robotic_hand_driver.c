@@ -8,7 +8,25 @@
 #include <linux/device.h>     // Necesario para class_create/device_create
 #include <linux/uaccess.h>    // Necesario para copy_from_user
 #include <asm/io.h>           // Necesario para ioremap/iounmap
-#include <linux/delay.h>      // Necesario para msleep
+#include <linux/version.h>    // Necesario para LINUX_VERSION_CODE
+#include <linux/slab.h>       // Necesario para kzalloc (banco de registros simulado)
+#include <linux/kfifo.h>      // Necesario para la cola de comandos
+#include <linux/hrtimer.h>    // Necesario para el temporizador de los pulsos
+#include <linux/spinlock.h>   // Necesario para proteger la cola y los registros
+#include <linux/wait.h>       // Necesario para las colas de espera de write/fsync
+#include <linux/bitops.h>     // Necesario para hweight8/hweight32
+#include <linux/string.h>     // Necesario para strchr/memset
+#include <linux/mm.h>         // Necesario para mmap del anillo
+#include <linux/vmalloc.h>    // Necesario para vmalloc_user/remap_vmalloc_range
+#include <linux/poll.h>       // Necesario para poll() sobre los completados
+#include <linux/debugfs.h>    // Necesario para exportar las estadisticas
+#include <linux/seq_file.h>   // Necesario para el archivo de estadisticas
+#include <linux/atomic.h>     // Necesario para los contadores de write()
+
+#include "Biblioteca/robotic_hand_cmd.h" // Formato de los comandos (compartido con la biblioteca)
+
+#define CREATE_TRACE_POINTS
+#include "robotic_hand_trace.h"          // Tracepoints: comando recibido, pulso, profundidad de la cola
 
 // --- Metadatos del modulo ---
 MODULE_LICENSE("GPL");
@@ -22,237 +40,819 @@ MODULE_VERSION("1.0");
 
 static dev_t major_number;
 static struct class* robotic_class = NULL;
-static struct device* robotic_device = NULL;
-static struct cdev my_cdev;
 
 // --- PUNTO CRITICO: Puntero al espacio de la MEMORIA VIRTUAL para los registros GPIO ---
 // Basicamente, es la forma de acceder al hardware directamente
 // La direccion fisica base de los puertos en una Raspberry Pi es 0xFE000000.
 // El offset para el controlador GPIO es 0x200000
+// El banco es uno solo para todas las manos: GPSET0/GPCLR0 solo ponen en 1/0 los bits
+// escritos, asi que cada mano los escribe sin coordinarse con las demas.
 #define GPIO_BASE_PHYS  0xFE200000
 #define GPIO_SIZE       0x84
 static void __iomem *gpio_base_vaddr;
 
+// --- Banco de registros simulado ---
+// Con simulado=1 los "registros" son un buffer de kzalloc en lugar del ioremap:
+// el modulo carga en cualquier VM y se puede medir el ritmo de comandos y el jitter.
+static bool simulado = false;
+module_param(simulado, bool, 0444);
+MODULE_PARM_DESC(simulado, "Usar un banco de registros en memoria en lugar de GPIO_BASE_PHYS");
+
 // --- Constantes de registros (para mayor claridad) ---
-#define GPFSEL1_OFFSET 0x04
-#define GPFSEL2_OFFSET 0x08
 #define GPSET0_OFFSET  0x1C
 #define GPCLR0_OFFSET  0x28
-#define PULSE_MS       100
+#define PULSE_MS       100   // Ancho por defecto de cada eje al cargar el modulo
+
+// --- Manos: un minor por mano, cada una con su mapa de pines ---
+// pines=17,18,27,22,23,24,5,6,12,13,16,26 son dos manos: 6 GPIO por mano, en el orden
+// de los ejes de robotic_hand_cmd.h. Sin el parametro hay una sola mano con el mapa de
+// siempre. La mano 0 es /dev/robotic_hand y la i es /dev/robotic_handi.
+// Solo GPIO 0 a 27 (los del conector, todos en GPSET0/GPCLR0) y sin repetir.
+#define MAX_MANOS    4
+#define MAX_PIN_GPIO 27
+
+static int pines[MAX_MANOS * RH_NUM_EJES];
+static int num_pines;
+module_param_array(pines, int, &num_pines, 0444);
+MODULE_PARM_DESC(pines, "GPIO de cada eje de cada mano, 6 por mano en orden ATDISB (por defecto 17,18,27,22,23,24)");
+
+static const int pines_por_defecto[RH_NUM_EJES] = { 17, 18, 27, 22, 23, 24 };
+
+// --- Mapa de ejes (en el orden de robotic_hand_cmd.h) ---
+// Segun la documentacion de BCM2711
+// * GPFSELn: Configura la función del pin (000 = entrada, 001 = salida); 10 pines por
+//   registro, 3 bits cada uno: GPIO 17 es GPFSEL1 bits 23-21, GPIO 22 es GPFSEL2 bits 8-6
+// * GPSETn: Pone un pin en ALTO (HIGH)
+// * GPCLRn: Pone un pin en BAJO (LOW)
+// Todos los pines estan en GPSET0/GPCLR0, asi que varios ejes cambian con una sola
+// escritura de la mascara de sus bits.
+struct eje_gpio {
+    u8 pin;                 // GPIO del eje
+    u8 fsel_offset;         // Registro GPFSELn del pin
+    u8 fsel_shift;          // Primer bit de los 3 del pin en GPFSELn
+};
+
+// --- Cola de comandos y motor de pulsos ---
+// write() solo encola y vuelve; un hrtimer sube juntos los pines de cada comando,
+// baja cada uno cuando vence su duracion y, cuando bajo el ultimo, repite el comando
+// o toma el siguiente. Un eje no vuelve a subir hasta cumplir su pausa. Cada mano tiene
+// su cola, su timer y su spinlock (que protege la cola, el estado del motor y la
+// configuracion de los ejes): los comandos de manos distintas nunca se esperan entre si.
+#define TAMANO_COLA 256 // Comandos en espera (potencia de 2, requisito de kfifo)
+#define LOTE_WRITE  32  // Bytes que write() copia del usuario por vuelta
+#define CUBETAS_LATENCIA 32
+
+struct comando_motor {
+    u8 ejes;                // Mascara de ejes (bit RH_EJE_*)
+    u8 tipo;                // enum tipo_comando (robotic_hand_trace.h)
+    u16 ms[RH_NUM_EJES];    // Ancho del pulso de cada eje de la mascara (0 = pulso_ms del eje)
+    u16 repeticiones;       // Pulsos seguidos (0 o 1 = uno)
+    u32 encolado_us;        // Cuando entro por write() (o salio del anillo); 32 bits alcanzan
+                            // para latencias de ~71 minutos y el lote de write() sigue chico
+};
+
+// --- Anillo de comandos compartido con el usuario (ver robotic_hand_cmd.h) ---
+// El timer consume el anillo cuando la cola de write() esta vacia. El driver no se fia
+// de los indices de la memoria compartida: lleva los suyos en la mano y del productor
+// solo lee sq_cola y cq_cabeza.
+#define RING_MASCARA (RH_RING_ENTRADAS - 1)
+
+struct mano {
+    int indice;
+    struct cdev cdev;
+    struct device *device;
+    struct eje_gpio ejes[RH_NUM_EJES];
+    struct dentry *dir_debugfs;
+
+    // Motor (todo protegido por lock)
+    DECLARE_KFIFO(cola_comandos, struct comando_motor, TAMANO_COLA);
+    spinlock_t lock;
+    wait_queue_head_t espera_espacio;       // write() esperando lugar en la cola
+    wait_queue_head_t espera_drenado;       // fsync() esperando que todo termine
+    wait_queue_head_t espera_completados;   // poll() esperando completados
+    struct hrtimer timer;
+    bool activo;                            // El timer esta armado
+    u32 pines_en_alto;                      // Mascara GPSET0 de los pines del comando en curso
+    ktime_t fin_eje[RH_NUM_EJES];           // Cuando baja cada eje del comando en curso
+    ktime_t libre_eje[RH_NUM_EJES];         // Desde cuando cada eje puede volver a subir
+    struct comando_motor actual;            // Comando en curso (actual.ejes == 0: ninguno)
+    u16 repeticiones_restantes;             // Pulsos que le faltan a 'actual', contando el de ahora
+
+    // Configuracion de cada eje (RH_IOC_SET_EJE)
+    u16 pulso_ms[RH_NUM_EJES];
+    u16 pausa_ms[RH_NUM_EJES];
+
+    // Anillo
+    struct rh_ring *ring;
+    u32 ring_sq_cabeza, ring_cq_cola;
+    struct file *ring_dueno;                // Unico productor: el archivo que hizo mmap
+    bool ring_en_curso;                     // El comando en curso vino del anillo
+    u64 ring_user_data;                     // user_data del comando en curso del anillo
+
+    // Estadisticas: debugfs (robotic_hand/manoN/estadisticas) y un resumen al descargar
+    unsigned long pulsos_emitidos;
+    s64 atraso_max_ns;                      // Peor atraso del timer respecto de lo programado
+    u64 comandos_por_tipo[NUM_TIPOS];       // Comandos terminados de cada tipo
+    u64 anillo_invalidos;                   // Entradas del anillo completadas con -EINVAL
+    u64 latencia_us[CUBETAS_LATENCIA];      // Cubeta b: [2^(b-1), 2^b) us de write() a bajar el ultimo pin
+    atomic64_t bytes_ignorados;             // Bytes de write() que no eran comandos (sin lock)
+} ____cacheline_aligned_in_smp;
+
+static struct mano *manos;
+static int num_manos;
+static struct dentry *dir_debugfs;
 
 // Declaracion de las funciones de file_operations
 static int      dev_open(struct inode *, struct file *);
 static int      dev_release(struct inode *, struct file *);
 static ssize_t  dev_write(struct file *, const char *, size_t, loff_t *);
+static int      dev_fsync(struct file *, loff_t, loff_t, int);
+static int      dev_mmap(struct file *, struct vm_area_struct *);
+static __poll_t dev_poll(struct file *, struct poll_table_struct *);
+static long     dev_ioctl(struct file *, unsigned int, unsigned long);
 
 // Estructura que asocia las funciones con las operaciones de archivo
 static struct file_operations fops = {
     .open = dev_open,
     .release = dev_release,
     .write = dev_write,
+    .fsync = dev_fsync,
+    .mmap = dev_mmap,
+    .poll = dev_poll,
+    .unlocked_ioctl = dev_ioctl,
     .owner = THIS_MODULE,
 };
 
+static u32 bit_pin(const struct mano *m, int eje) {
+    return 1u << m->ejes[eje].pin;
+}
+
+// Completados que el productor todavia no cosecho
+static u32 ring_completados(struct mano *m) {
+    return READ_ONCE(m->ring_cq_cola) - READ_ONCE(m->ring->cq_cabeza);
+}
+
+// --- Deja un completado en cq; despierta al productor solo si ya tiene los que espera ---
+static void ring_completar(struct mano *m, u64 user_data, s32 resultado) {
+    struct rh_cqe *cqe = &m->ring->cq[m->ring_cq_cola & RING_MASCARA];
+    u32 esperando;
+
+    cqe->user_data = user_data;
+    cqe->resultado = resultado;
+    smp_store_release(&m->ring->cq_cola, ++m->ring_cq_cola);
+    smp_mb(); // cq_cola visible antes de mirar cq_esperando (el productor hace lo inverso)
+    esperando = READ_ONCE(m->ring->cq_esperando);
+    if (esperando && ring_completados(m) >= esperando) wake_up_interruptible(&m->espera_completados);
+}
+
+// Hay un comando en sq y lugar en cq para su completado (indices fuera de rango = vacio)
+static bool ring_hay_trabajo(struct mano *m) {
+    u32 pendientes = smp_load_acquire(&m->ring->sq_cola) - m->ring_sq_cabeza;
+
+    return pendientes > 0 && pendientes <= RH_RING_ENTRADAS &&
+           m->ring_cq_cola - smp_load_acquire(&m->ring->cq_cabeza) < RH_RING_ENTRADAS;
+}
+
+// --- Toma el siguiente comando valido del anillo; los invalidos se completan con -EINVAL ---
+static bool ring_tomar(struct mano *m, struct comando_motor *cmd) {
+    const struct rh_sqe *sqe;
+    int e;
+
+    while (ring_hay_trabajo(m)) {
+        sqe = &m->ring->sq[m->ring_sq_cabeza & RING_MASCARA];
+        memset(cmd, 0, sizeof(*cmd));
+        cmd->ejes = READ_ONCE(sqe->ejes) & RH_MASCARA_EJES;
+        for (e = 0; e < RH_NUM_EJES; ++e) {
+            if (cmd->ejes & (1 << e)) cmd->ms[e] = READ_ONCE(sqe->ms[e]);
+        }
+        cmd->repeticiones = READ_ONCE(sqe->repeticiones);
+        cmd->tipo = TIPO_ANILLO;
+        cmd->encolado_us = ktime_to_us(ktime_get());
+        m->ring_user_data = READ_ONCE(sqe->user_data);
+        if (READ_ONCE(sqe->ejes) != cmd->ejes) cmd->ejes = 0; // Bits fuera de la mascara
+        smp_store_release(&m->ring->sq_cabeza, ++m->ring_sq_cabeza); // Entrada copiada: el productor la puede reusar
+        if (cmd->ejes) {
+            trace_rh_comando_recibido(m->indice, cmd->tipo, cmd->ejes, cmd->repeticiones);
+            m->ring_en_curso = true;
+            return true;
+        }
+        m->anillo_invalidos++;
+        ring_completar(m, m->ring_user_data, -EINVAL);
+    }
+    return false;
+}
+
+// --- Sin trabajo: pide que lo despierten. Devuelve true si justo llego un comando ---
+static bool ring_dormir(struct mano *m) {
+    WRITE_ONCE(m->ring->sq_flags, RH_RING_DESPERTAR);
+    smp_mb(); // El flag visible antes de volver a mirar sq_cola (el productor hace lo inverso)
+    if (!ring_hay_trabajo(m)) return false;
+    WRITE_ONCE(m->ring->sq_flags, 0);
+    return true;
+}
+
+// Comandos esperando en la cola de write() y en el anillo
+static void trazar_profundidad(struct mano *m) {
+    trace_rh_profundidad_cola(m->indice, kfifo_len(&m->cola_comandos),
+                              READ_ONCE(m->ring->sq_cola) - m->ring_sq_cabeza);
+}
+
+// --- Siguiente comando (primero los de write(), despues el anillo) a 'actual' ---
+static bool motor_siguiente(struct mano *m) {
+    if (!kfifo_get(&m->cola_comandos, &m->actual) && !ring_tomar(m, &m->actual)) return false;
+    m->repeticiones_restantes = m->actual.repeticiones ? m->actual.repeticiones : 1;
+    trazar_profundidad(m);
+    return true;
+}
+
+// --- Termino el comando en curso: contadores e histograma de latencia ---
+static u32 motor_terminar(struct mano *m, ktime_t ahora) {
+    u32 latencia = (u32)ktime_to_us(ahora) - m->actual.encolado_us;
+
+    m->comandos_por_tipo[m->actual.tipo]++;
+    m->latencia_us[min_t(int, fls(latencia), CUBETAS_LATENCIA - 1)]++;
+    if (m->ring_en_curso) { // Si vino del anillo, su completado
+        m->ring_en_curso = false;
+        ring_completar(m, m->ring_user_data, 0);
+    }
+    m->actual.ejes = 0;
+    return latencia;
+}
+
+// --- Callback del hrtimer: baja los pines vencidos y, si no queda ninguno, arranca el siguiente pulso ---
+// Corre en contexto de interrupcion: nada de sleeps, solo registros y la cola.
+static enum hrtimer_restart motor_tick(struct hrtimer *timer) {
+    struct mano *m = container_of(timer, struct mano, timer);
+    enum hrtimer_restart ret = HRTIMER_NORESTART;
+    unsigned long flags;
+    ktime_t ahora = ktime_get();
+    ktime_t proximo = KTIME_MAX;
+    s64 atraso = ktime_to_ns(ktime_sub(ahora, hrtimer_get_expires(timer)));
+    u32 bajar = 0;
+    int e;
+
+    spin_lock_irqsave(&m->lock, flags);
+    if (atraso > m->atraso_max_ns) m->atraso_max_ns = atraso;
+
+    // 1. Bajar, con una sola escritura a GPCLR0, los pines cuyo pulso vencio
+    for (e = 0; e < RH_NUM_EJES; ++e) {
+        if (!(m->pines_en_alto & bit_pin(m, e))) continue;
+        if (ktime_compare(m->fin_eje[e], ahora) <= 0) {
+            bajar |= bit_pin(m, e);
+        } else if (ktime_compare(m->fin_eje[e], proximo) < 0) {
+            proximo = m->fin_eje[e];
+        }
+    }
+    if (bajar) {
+        u32 latencia = 0;
+
+        iowrite32(bajar, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
+        m->pines_en_alto &= ~bajar;
+        m->pulsos_emitidos += hweight32(bajar);
+        for (e = 0; e < RH_NUM_EJES; ++e) {
+            if (bajar & bit_pin(m, e)) m->libre_eje[e] = ktime_add_ms(ahora, m->pausa_ms[e]);
+        }
+
+        // 2. Bajo el ultimo pin del pulso: si era la ultima repeticion el comando termino
+        if (!m->pines_en_alto && --m->repeticiones_restantes == 0) latencia = motor_terminar(m, ahora);
+        trace_rh_pulso_fin(m->indice, bajar, latencia);
+    }
+
+    // 3. Otra repeticion o el siguiente comando: cuando todos sus ejes cumplieron la
+    //    pausa, a ALTO con una escritura a GPSET0
+    if (!m->pines_en_alto && (m->actual.ejes || motor_siguiente(m))) {
+        ktime_t inicio = ahora;
+
+        for (e = 0; e < RH_NUM_EJES; ++e) {
+            if ((m->actual.ejes & (1 << e)) && ktime_compare(m->libre_eje[e], inicio) > 0) inicio = m->libre_eje[e];
+        }
+        if (ktime_compare(inicio, ahora) > 0) {
+            proximo = inicio; // Algun eje todavia descansa
+        } else {
+            for (e = 0; e < RH_NUM_EJES; ++e) {
+                if (!(m->actual.ejes & (1 << e))) continue;
+                m->fin_eje[e] = ktime_add_ms(ahora, m->actual.ms[e] ? m->actual.ms[e] : m->pulso_ms[e]);
+                if (ktime_compare(m->fin_eje[e], proximo) < 0) proximo = m->fin_eje[e];
+                m->pines_en_alto |= bit_pin(m, e);
+            }
+            iowrite32(m->pines_en_alto, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
+            trace_rh_pulso_inicio(m->indice, m->pines_en_alto, m->repeticiones_restantes);
+        }
+    }
+
+    if (proximo != KTIME_MAX) {
+        hrtimer_set_expires(timer, proximo);
+        ret = HRTIMER_RESTART;
+    } else if (ring_dormir(m)) {
+        hrtimer_set_expires(timer, ahora); // Llego un comando al anillo mientras se detenia
+        ret = HRTIMER_RESTART;
+    } else {
+        m->activo = false;
+    }
+    spin_unlock_irqrestore(&m->lock, flags);
+
+    wake_up_interruptible(&m->espera_espacio);
+    if (ret == HRTIMER_NORESTART) wake_up_interruptible(&m->espera_drenado);
+    return ret;
+}
+
+// --- Arranca el timer si estaba parado (con m->lock tomado) ---
+static void motor_arrancar(struct mano *m) {
+    WRITE_ONCE(m->ring->sq_flags, 0);
+    if (!m->activo) {
+        m->activo = true;
+        hrtimer_start(&m->timer, 0, HRTIMER_MODE_REL);
+    }
+}
+
+// --- Encola hasta n comandos en orden (un solo lock para todo el lote) ---
+// Devuelve cuantos entraron; arranca el timer si estaba parado.
+static unsigned int motor_encolar(struct mano *m, const struct comando_motor *cmds, unsigned int n) {
+    unsigned long flags;
+    unsigned int puestos, i;
+
+    spin_lock_irqsave(&m->lock, flags);
+    puestos = kfifo_in(&m->cola_comandos, cmds, n);
+    if (puestos > 0) motor_arrancar(m);
+    if (trace_rh_comando_recibido_enabled()) {
+        for (i = 0; i < puestos; ++i) {
+            trace_rh_comando_recibido(m->indice, cmds[i].tipo, cmds[i].ejes, cmds[i].repeticiones);
+        }
+    }
+    trazar_profundidad(m);
+    spin_unlock_irqrestore(&m->lock, flags);
+    return puestos;
+}
+
+static bool motor_en_reposo(struct mano *m) {
+    return !READ_ONCE(m->activo);
+}
+
+// --- Arma el mapa de pines de cada mano desde el parametro 'pines' ---
+// Devuelve la cantidad de manos, o -EINVAL si el parametro no sirve.
+static int leer_mapa_pines(void) {
+    u32 usados = 0;
+    int n = num_pines ? num_pines : RH_NUM_EJES;
+    int i, pin;
+
+    if (n % RH_NUM_EJES != 0) {
+        printk(KERN_ALERT "RoboticTEC Driver: pines= necesita %d GPIO por mano (hay %d)\n", RH_NUM_EJES, n);
+        return -EINVAL;
+    }
+    for (i = 0; i < n; ++i) {
+        pin = num_pines ? pines[i] : pines_por_defecto[i];
+        if (pin < 0 || pin > MAX_PIN_GPIO || (usados & (1u << pin))) {
+            printk(KERN_ALERT "RoboticTEC Driver: GPIO %d invalido o repetido en pines=\n", pin);
+            return -EINVAL;
+        }
+        usados |= 1u << pin;
+        pines[i] = pin;
+    }
+    return n / RH_NUM_EJES;
+}
+
+// --- Prepara la mano i (cola, timer, anillo, mapa de pines); 0 o -ENOMEM ---
+static int iniciar_mano(struct mano *m, int i) {
+    int e;
+
+    m->indice = i;
+    spin_lock_init(&m->lock);
+    INIT_KFIFO(m->cola_comandos);
+    init_waitqueue_head(&m->espera_espacio);
+    init_waitqueue_head(&m->espera_drenado);
+    init_waitqueue_head(&m->espera_completados);
+    atomic64_set(&m->bytes_ignorados, 0);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+    hrtimer_setup(&m->timer, motor_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
+    hrtimer_init(&m->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    m->timer.function = motor_tick;
+#endif
+    for (e = 0; e < RH_NUM_EJES; ++e) {
+        int pin = pines[i * RH_NUM_EJES + e];
+
+        m->ejes[e].pin = pin;
+        m->ejes[e].fsel_offset = (pin / 10) * 4;
+        m->ejes[e].fsel_shift = (pin % 10) * 3;
+        m->pulso_ms[e] = PULSE_MS;
+    }
+    m->ring = vmalloc_user(sizeof(*m->ring)); // En cero y con paginas que se pueden mapear al usuario
+    return m->ring ? 0 : -ENOMEM;
+}
+
+// --- Pone en modo salida (001) el pin de cada eje; se hace una vez al cargar el modulo ---
+static void configurar_pines(const struct mano *m) {
+    unsigned int reg_val;
+    int e;
+
+    for (e = 0; e < RH_NUM_EJES; ++e) {
+        reg_val = ioread32(gpio_base_vaddr + m->ejes[e].fsel_offset);
+        reg_val &= ~(7 << m->ejes[e].fsel_shift); // Limpiar los 3 bits del pin
+        reg_val |= (1 << m->ejes[e].fsel_shift);  // Establecer el modo salida (001)
+        iowrite32(reg_val, gpio_base_vaddr + m->ejes[e].fsel_offset);
+    }
+}
+
+// --- debugfs: /sys/kernel/debug/robotic_hand/manoN/estadisticas ---
+// Se copia todo bajo el lock y se imprime afuera, para no frenar al timer.
+static int estadisticas_show(struct seq_file *s, void *unused) {
+    static const char *const nombres[NUM_TIPOS] = { "letra", "ejes", "pasos", "anillo" };
+    struct mano *m = s->private;
+    u64 por_tipo[NUM_TIPOS], latencias[CUBETAS_LATENCIA], invalidos;
+    unsigned long pulsos, flags;
+    s64 atraso;
+    int i;
+
+    spin_lock_irqsave(&m->lock, flags);
+    memcpy(por_tipo, m->comandos_por_tipo, sizeof(por_tipo));
+    memcpy(latencias, m->latencia_us, sizeof(latencias));
+    invalidos = m->anillo_invalidos;
+    pulsos = m->pulsos_emitidos;
+    atraso = m->atraso_max_ns;
+    spin_unlock_irqrestore(&m->lock, flags);
+
+    for (i = 0; i < NUM_TIPOS; ++i) seq_printf(s, "comandos_%s %llu\n", nombres[i], por_tipo[i]);
+    seq_printf(s, "anillo_invalidos %llu\n", invalidos);
+    seq_printf(s, "bytes_ignorados %lld\n", (long long)atomic64_read(&m->bytes_ignorados));
+    seq_printf(s, "pulsos_emitidos %lu\n", pulsos);
+    seq_printf(s, "atraso_max_timer_us %lld\n", div_s64(atraso, NSEC_PER_USEC));
+    // Histograma log2 de la latencia de write() (o de salir del anillo) a bajar el ultimo pin
+    seq_puts(s, "latencia_us\n");
+    for (i = 0; i < CUBETAS_LATENCIA; ++i) {
+        if (!latencias[i]) continue;
+        if (i == CUBETAS_LATENCIA - 1) {
+            seq_printf(s, "  [%u, inf) %llu\n", 1u << (i - 1), latencias[i]);
+        } else {
+            seq_printf(s, "  [%u, %u) %llu\n", i ? 1u << (i - 1) : 0, 1u << i, latencias[i]);
+        }
+    }
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(estadisticas);
+
+// --- Quita /dev/robotic_hand* de las manos 0 a creadas - 1 ---
+static void quitar_dispositivos(int creadas) {
+    int i;
+
+    for (i = 0; i < creadas; ++i) {
+        device_destroy(robotic_class, MKDEV(MAJOR(major_number), i));
+        cdev_del(&manos[i].cdev);
+    }
+}
+
+// --- Detiene el motor de cada mano (bajando sus pines si quedaron en ALTO) y las libera ---
+static void liberar_manos(void) {
+    int i;
+
+    for (i = 0; i < num_manos; ++i) {
+        // El timer se cancela primero: si quedaban pines en ALTO se bajan a mano
+        hrtimer_cancel(&manos[i].timer);
+        if (gpio_base_vaddr && manos[i].pines_en_alto) {
+            iowrite32(manos[i].pines_en_alto, gpio_base_vaddr + GPCLR0_OFFSET);
+        }
+        vfree(manos[i].ring);
+    }
+    kfree(manos);
+}
+
+static void desmapear_gpio(void) {
+    if (simulado) {
+        kfree((__force void *)gpio_base_vaddr);
+    } else {
+        iounmap(gpio_base_vaddr);
+    }
+    gpio_base_vaddr = NULL;
+}
+
 // --- Funcion de inicializacion del modulo ---
 static int __init robotic_hand_init(void) {
+    char nombre[16];
+    int i, ret;
+
     printk(KERN_INFO "RoboticTEC Driver: Inicializando...\n");
 
-    // 1. Obtener el major number de forma dinamica
-    if (alloc_chrdev_region(&major_number, 0, 1, DEVICE_NAME) < 0) {
+    // 0. Manos y motor de pulsos: listos antes de que alguien pueda abrir un dispositivo
+    num_manos = leer_mapa_pines();
+    if (num_manos < 0) return num_manos;
+    manos = kcalloc(num_manos, sizeof(*manos), GFP_KERNEL);
+    if (!manos) return -ENOMEM;
+    for (i = 0; i < num_manos; ++i) {
+        if (iniciar_mano(&manos[i], i) < 0) {
+            printk(KERN_ALERT "RoboticTEC Driver: Fallo al reservar el anillo de comandos\n");
+            num_manos = i + 1;
+            ret = -ENOMEM;
+            goto err_manos;
+        }
+    }
+
+    // 1. IMPORTANTE: Aqui se mapea la memoria FISICA a los registros GPIO a la memoria virtual del kernel
+    //    (o, con simulado=1, un buffer comun que hace de banco de registros). Va antes de
+    //    crear los dispositivos: un write() temprano ya encuentra los registros.
+    if (simulado) {
+        gpio_base_vaddr = (__force void __iomem *)kzalloc(GPIO_SIZE, GFP_KERNEL);
+    } else {
+        gpio_base_vaddr = ioremap(GPIO_BASE_PHYS, GPIO_SIZE);
+    }
+    if (!gpio_base_vaddr) {
+        printk(KERN_ALERT "RoboticTEC Driver: Fallo al mapear memoria GPIO (ioremap)\n");
+        ret = -ENOMEM;
+        goto err_manos;
+    }
+    printk(KERN_INFO "RoboticTEC Driver: Memoria GPIO %s correctamente.\n",
+           simulado ? "simulada" : "mapeada");
+
+    // 2. Configurar los pines de todos los ejes de todas las manos como salida, una sola vez
+    for (i = 0; i < num_manos; ++i) configurar_pines(&manos[i]);
+
+    // 3. Obtener el major number de forma dinamica, un minor por mano
+    ret = alloc_chrdev_region(&major_number, 0, num_manos, DEVICE_NAME);
+    if (ret < 0) {
         printk(KERN_ALERT "RoboticTEC Driver: Fallo al asignar major number\n");
-        return -1;
+        goto err_manos;
     }
     printk(KERN_INFO "RoboticTEC Driver: Major number %d asignado.\n", MAJOR(major_number));
 
-    // 2. Crear una clase para dispositivo
+    // 4. Crear una clase para dispositivo
     robotic_class = class_create(CLASS_NAME);
     if(IS_ERR(robotic_class)) {
-        unregister_chrdev_region(major_number, 1);
         printk(KERN_ALERT "RoboticTEC Driver: Fallo al crear la clase de dispositivo\n");
-        return PTR_ERR(robotic_class);
+        ret = PTR_ERR(robotic_class);
+        goto err_region;
     }
     printk(KERN_INFO "RoboticTEC Driver: Clase de dispositivo creada.\n");
 
-    // 3. Crear el dispositivo en /dev/robotic_hand
-    robotic_device = device_create(robotic_class, NULL, major_number, NULL, DEVICE_NAME);
-    if (IS_ERR(robotic_device)) {
-        class_destroy(robotic_class);
-        unregister_chrdev_region(major_number, 1);
-        printk(KERN_ALERT "RoboticTEC Driver: Fallo al crear el dispositivo\n");
-        return PTR_ERR(robotic_device);
+    // 5. Por mano: cdev y /dev/robotic_hand (mano 0), /dev/robotic_hand1, ...
+    for (i = 0; i < num_manos; ++i) {
+        struct mano *m = &manos[i];
+        dev_t devt = MKDEV(MAJOR(major_number), i);
+
+        cdev_init(&m->cdev, &fops);
+        m->cdev.owner = THIS_MODULE;
+        ret = cdev_add(&m->cdev, devt, 1);
+        if (ret < 0) {
+            printk(KERN_ALERT "RoboticTEC Driver: Fallo al agregar cdev\n");
+            goto err_dispositivos;
+        }
+        if (i == 0) {
+            m->device = device_create(robotic_class, NULL, devt, m, DEVICE_NAME);
+        } else {
+            m->device = device_create(robotic_class, NULL, devt, m, DEVICE_NAME "%d", i);
+        }
+        if (IS_ERR(m->device)) {
+            cdev_del(&m->cdev);
+            printk(KERN_ALERT "RoboticTEC Driver: Fallo al crear el dispositivo\n");
+            ret = PTR_ERR(m->device);
+            goto err_dispositivos;
+        }
     }
-    printk(KERN_INFO "RoboticTEC Driver: Dispositivo /dev/robotic_hand creado.\n");
-
-    // 4. Iniciar y agregar el dispositivo de caracteres (cdev)
-    cdev_init(&my_cdev, &fops);
-    if(cdev_add(&my_cdev, major_number, 1) < 0) {
-        device_destroy(robotic_class, major_number);
-        class_destroy(robotic_class);
-        unregister_chrdev_region(major_number, 1);
-        printk(KERN_ALERT "RoboticTEC Driver: Fallo al agregar cdev\n");
-        return -1;
+    printk(KERN_INFO "RoboticTEC Driver: %d mano(s) creada(s), la primera en /dev/robotic_hand.\n", num_manos);
+
+    // 6. Estadisticas en debugfs (si debugfs no esta, el modulo funciona igual)
+    dir_debugfs = debugfs_create_dir(DEVICE_NAME, NULL);
+    for (i = 0; i < num_manos; ++i) {
+        snprintf(nombre, sizeof(nombre), "mano%d", i);
+        manos[i].dir_debugfs = debugfs_create_dir(nombre, dir_debugfs);
+        debugfs_create_file("estadisticas", 0444, manos[i].dir_debugfs, &manos[i], &estadisticas_fops);
     }
 
-    // 5. IMPORTANTE: Aqui se mapea la memoria FISICA a los registros GPIO a la memoria virtual del kernel
-    gpio_base_vaddr = ioremap(GPIO_BASE_PHYS, GPIO_SIZE);
-    if (!gpio_base_vaddr) {
-        // Limpiar todo si falla el mapeo
-        cdev_del(&my_cdev);
-        device_destroy(robotic_class, major_number);
-        class_destroy(robotic_class);
-        unregister_chrdev_region(major_number, 1);
-        printk(KERN_ALERT "RoboticTEC Driver: Fallo al mapear memoria GPIO (ioremap)\n");
-        return -ENOMEM;
-    }
-    printk(KERN_INFO "RoboticTEC Driver: Memoria GPIO mapeada correctamente.\n");
-
-    // Configurar los pines GPIO como salida
-    
     printk(KERN_INFO "RoboticTEC Driver: Módulo cargado exitosamente.\n");
     return 0;
+
+    // Limpiar en orden inverso lo que se alcanzo a hacer
+err_dispositivos:
+    quitar_dispositivos(i);
+    class_destroy(robotic_class);
+err_region:
+    unregister_chrdev_region(major_number, num_manos);
+err_manos:
+    liberar_manos();
+    if (gpio_base_vaddr) desmapear_gpio();
+    return ret;
 }
 
 // --- Funcion de salida del modulo ---
 static void __exit robotic_hand_exit(void) {
+    int i;
+
     printk(KERN_INFO "RoboticTEC Driver: Desinstalando módulo...\n");
+    debugfs_remove_recursive(dir_debugfs);
 
     // Deshacer todo en orden inverso
-    iounmap(gpio_base_vaddr);
-    cdev_del(&my_cdev);
-    device_destroy(robotic_class, major_number);
+    for (i = 0; i < num_manos; ++i) {
+        printk(KERN_INFO "RoboticTEC Driver: mano %d: %lu pulsos emitidos, atraso maximo del timer %lld us.\n",
+               i, manos[i].pulsos_emitidos, div_s64(manos[i].atraso_max_ns, NSEC_PER_USEC));
+    }
+    quitar_dispositivos(num_manos);
     class_destroy(robotic_class);
-    unregister_chrdev_region(major_number, 1);
+    unregister_chrdev_region(major_number, num_manos);
+    liberar_manos();
+    desmapear_gpio();
 
     printk(KERN_INFO "RoboticTEC Driver: Módulo desinstalado.\n");
 }
 
 // --- file ops ---
-// cuando se hace open(/dev/robotic_hand)
+// cuando se hace open(/dev/robotic_hand[N]): el archivo queda asociado a su mano
 static int dev_open(struct inode *inodep, struct file *filep) {
-    printk(KERN_INFO "RoboticTEC Driver: Dispositivo abierto.\n");
+    filep->private_data = container_of(inodep->i_cdev, struct mano, cdev);
     return 0;
 }
 
 // cuando se hace close()
+// Si era el productor del anillo (ya sin mmap), lo que quedo en el anillo se descarta
+// y el proximo que haga mmap lo encuentra vacio.
 static int dev_release(struct inode *inodep, struct file *filep) {
-    printk(KERN_INFO "RoboticTEC Driver: Dispositivo cerrado.\n");
+    struct mano *m = filep->private_data;
+    unsigned long flags;
+
+    if (READ_ONCE(m->ring_dueno) == filep) {
+        spin_lock_irqsave(&m->lock, flags);
+        memset(m->ring, 0, offsetof(struct rh_ring, sq));
+        m->ring_sq_cabeza = m->ring_cq_cola = 0;
+        m->ring_en_curso = false;
+        spin_unlock_irqrestore(&m->lock, flags);
+        WRITE_ONCE(m->ring_dueno, NULL);
+    }
     return 0;
 }
 
+// --- Decodifica el comando que empieza en buf (ver robotic_hand_cmd.h) ---
+// Devuelve los bytes que ocupa, 0 si el comando esta incompleto (faltan bytes) o
+// -EINVAL si el byte no es un comando. Un comando que no hace nada (0 pasos) ocupa
+// sus bytes y deja cmd->ejes en 0.
+static int decodificar_comando(const u8 *buf, size_t n, struct comando_motor *cmd) {
+    const char *letra;
+    int e, usados = 1;
+
+    memset(cmd, 0, sizeof(*cmd));
+    if ((buf[0] & ~RH_MASCARA_EJES) == RH_OP_EJES) {
+        cmd->tipo = TIPO_EJES;
+        cmd->ejes = buf[0] & RH_MASCARA_EJES;
+        if (!cmd->ejes) return -EINVAL;
+        if (n < 1 + 2 * (size_t)hweight8(cmd->ejes)) return 0;
+        for (e = 0; e < RH_NUM_EJES; ++e) {
+            if (!(cmd->ejes & (1 << e))) continue;
+            cmd->ms[e] = buf[usados] | (buf[usados + 1] << 8); // __le16
+            usados += 2;
+        }
+        return usados;
+    }
+
+    // Pasos: N pulsos del ancho por defecto de un eje
+    if ((buf[0] & ~7) == RH_OP_PASOS && (buf[0] & 7) < RH_NUM_EJES) {
+        if (n < 3) return 0;
+        cmd->tipo = TIPO_PASOS;
+        cmd->repeticiones = buf[1] | (buf[2] << 8); // __le16
+        if (cmd->repeticiones) cmd->ejes = 1 << (buf[0] & 7);
+        return 3;
+    }
+
+    // Comando de una letra: un pulso del ancho por defecto de su eje
+    letra = buf[0] ? strchr(RH_LETRAS_EJES, buf[0]) : NULL;
+    if (!letra) return -EINVAL;
+    cmd->tipo = TIPO_LETRA;
+    cmd->ejes = 1 << (letra - RH_LETRAS_EJES);
+    return 1;
+}
+
 // cuando se hace write()
+// Todo el buffer es una secuencia de comandos completos que se encolan en orden; los
+// pulsos los genera motor_tick. Los bytes que no son comandos se saltean. Si la cola
+// se llena, espera lugar (con O_NONBLOCK devuelve lo que alcanzo a encolar, o -EAGAIN).
 static ssize_t dev_write(struct file *filep, const char __user *buffer, size_t len, loff_t *offset)  {
-    char command;
-    unsigned int reg_val;
-
-    if (len == 0 || copy_from_user(&command, buffer, 1) != 0) {
-        printk(KERN_ALERT "RoboticTEC: Error copiando datos desde el usuario\n");
-        return -EFAULT; // Error al copiar desde el espacio de usuario
+    struct mano *m = filep->private_data;
+    u8 lote[LOTE_WRITE];
+    struct comando_motor cmds[LOTE_WRITE];
+    u8 inicio[LOTE_WRITE];      // Posicion en 'lote' donde empieza cada comando decodificado
+    size_t copiado = 0;         // Bytes del usuario ya copiados a 'lote'
+    size_t base = 0;            // Bytes del usuario ya consumidos antes de lote[0]
+    size_t pendiente = 0;       // Comando incompleto al final del lote anterior
+    unsigned int ignorados = 0;
+
+    while (copiado < len) {
+        size_t n = min_t(size_t, len - copiado, LOTE_WRITE - pendiente);
+        size_t disponible = pendiente + n, pos = 0;
+        unsigned int validos = 0, puestos = 0, i;
+        u32 ahora_us;
+        int usados;
+
+        if (copy_from_user(lote + pendiente, buffer + copiado, n) != 0) {
+            printk(KERN_ALERT "RoboticTEC: Error copiando datos desde el usuario\n");
+            return base ? base : -EFAULT; // Error al copiar desde el espacio de usuario
+        }
+        copiado += n;
+
+        while (pos < disponible) {
+            usados = decodificar_comando(lote + pos, disponible - pos, &cmds[validos]);
+            if (usados == 0) break; // Sigue en el proximo lote
+            if (usados < 0) {
+                ignorados++;
+                pos++;
+                continue;
+            }
+            if (cmds[validos].ejes) inicio[validos++] = pos;
+            pos += usados;
+        }
+        ahora_us = ktime_to_us(ktime_get());
+        for (i = 0; i < validos; ++i) cmds[i].encolado_us = ahora_us;
+
+        while (puestos < validos) {
+            puestos += motor_encolar(m, cmds + puestos, validos - puestos);
+            if (puestos == validos) break;
+            // Cola llena: lo ya encolado cuenta como escrito
+            if (filep->f_flags & O_NONBLOCK) {
+                base += inicio[puestos];
+                return base ? base : -EAGAIN;
+            }
+            if (wait_event_interruptible(m->espera_espacio, !kfifo_is_full(&m->cola_comandos))) {
+                base += inicio[puestos];
+                return base ? base : -ERESTARTSYS;
+            }
+        }
+
+        pendiente = disponible - pos;
+        memmove(lote, lote + pos, pendiente);
+        base += pos;
     }
 
-    printk(KERN_INFO "RoboticTEC Driver: Recibido comando '%c'\n", command);
-
-    // Aqui se manipulan directamente los registros GPIO
-    // Segun la documentacion de BCM2711
-    // * GPFSELn: Configura la función del pin (000 = entrada, 001 = salida)
-    // * GPSETn: Pone un pin en ALTO (HIGH)
-    // * GPCLRn: Pone un pin en BAJO (LOW)
-
-    // Por ejemplo, para controlar GPIO 17
-    // GPFSEL1 esta en offset 0x04, GPIO 17 se configura con los bits 23-21
-    // Escribir '001' en esos bits lo configura como salida
-    // iowrite32((ioread32(gpio_base_vaddr + 0x04) & ~(7 << 21)) | (1 << 21), gpio_base_vaddr + 0x04);
-    
-    // GPSET0 esta en offset 0x1C. Bit 17 para GPIO 17
-    // iowrite32(1 << 17, gpio_base_vaddr + 0x1C);
-    
-    // GPCLR0 esta en offset 0x28. Bit 17 para GPIO 17
-    // iowrite32(1 << 17, gpio_base_vaddr + 0x28);
-
-    switch (command)
-    {
-    case 'A': // Adelante - GPIO 17
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL1_OFFSET);
-        reg_val &= ~(7 << 21); // Limpiar los 3 bits (23, 22, 21)
-        reg_val |= (1 << 21);  // Establecer el modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL1_OFFSET);
-        
-        // Generar pulso
-        iowrite32(1 << 17, gpio_base_vaddr + GPSET0_OFFSET); // Poner en ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 17, gpio_base_vaddr + GPCLR0_OFFSET); // Poner en BAJO
-        break;
-    
-    case 'T': // aTras - GPIO 18
-        // Configurar GPIO 18 como salida. Pertenece a GPFSEL1, bits 26-24.
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL1_OFFSET);
-        reg_val &= ~(7 << 24); // Limpiar bits 26, 25, 24
-        reg_val |= (1 << 24);  // Establecer modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL1_OFFSET);
-
-        // Generar pulso
-        iowrite32(1 << 18, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 18, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
-        break;
-    
-    case 'D': // D Derecha - GPIO 27
-        // Configurar GPIO 27 como salida. Pertenece a GPFSEL2, bits 23-21.
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL2_OFFSET);
-        reg_val &= ~(7 << 21); // Limpiar bits 23, 22, 21
-        reg_val |= (1 << 21);  // Establecer modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL2_OFFSET);
-
-        // Generar pulso
-        iowrite32(1 << 27, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 27, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
-        break;
-
-    case 'I': // Izquierda GPIO 22
-        // Configurar GPIO 22 como salida. Pertenece a GPFSEL2, bits 8-6.
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL2_OFFSET);
-        reg_val &= ~(7 << 6); // Limpiar bits 8, 7, 6
-        reg_val |= (1 << 6);  // Establecer modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL2_OFFSET);
-
-        // Generar pulso
-        iowrite32(1 << 22, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 22, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
-        break;
-    
-    case 'S':  // Subir GPIO 23
-        // Configurar GPIO 23 como salida. Pertenece a GPFSEL2, bits 11-9.
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL2_OFFSET);
-        reg_val &= ~(7 << 9); // Limpiar bits 11, 10, 9
-        reg_val |= (1 << 9);  // Establecer modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL2_OFFSET);
-
-        // Generar pulso
-        iowrite32(1 << 23, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 23, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
-        break;
-    
-    case 'B':   // Bajar - GPIO 24
-        // Configurar GPIO 24 como salida. Pertenece a GPFSEL2, bits 14-12.
-        reg_val = ioread32(gpio_base_vaddr + GPFSEL2_OFFSET);
-        reg_val &= ~(7 << 12); // Limpiar bits 14, 13, 12
-        reg_val |= (1 << 12);  // Establecer modo salida (001)
-        iowrite32(reg_val, gpio_base_vaddr + GPFSEL2_OFFSET);
-        
-        // Generar pulso
-        iowrite32(1 << 24, gpio_base_vaddr + GPSET0_OFFSET); // ALTO
-        msleep(PULSE_MS);
-        iowrite32(1 << 24, gpio_base_vaddr + GPCLR0_OFFSET); // BAJO
-        break;
-    
+    // Sin printk por llamada: lo que no era comando se cuenta (debugfs)
+    if (ignorados) atomic64_add(ignorados, &m->bytes_ignorados);
+    // Un comando cortado al final del buffer no se ejecuta: cada write lleva comandos completos
+    if (pendiente) return base ? base : -EINVAL;
+    return len;
+}
+
+// cuando se hace fsync(): espera a que se ejecuten todos los comandos encolados
+static int dev_fsync(struct file *filep, loff_t start, loff_t end, int datasync) {
+    struct mano *m = filep->private_data;
+
+    return wait_event_interruptible(m->espera_drenado, motor_en_reposo(m));
+}
+
+// cuando se hace mmap(): mapea el anillo de comandos. Un solo productor a la vez
+static int dev_mmap(struct file *filep, struct vm_area_struct *vma) {
+    struct mano *m = filep->private_data;
+    struct file *dueno = cmpxchg(&m->ring_dueno, NULL, filep);
+    int ret;
+
+    if (dueno && dueno != filep) return -EBUSY;
+    ret = remap_vmalloc_range(vma, m->ring, vma->vm_pgoff);
+    // Si este mmap fue el que tomo el anillo y no quedo mapeado, se suelta
+    if (ret && !dueno) WRITE_ONCE(m->ring_dueno, NULL);
+    return ret;
+}
+
+// cuando se hace poll(): legible si hay los completados que espera el productor (al
+// menos uno), escribible si write() no bloquea
+static __poll_t dev_poll(struct file *filep, struct poll_table_struct *tabla) {
+    struct mano *m = filep->private_data;
+    __poll_t mascara = 0;
+    u32 completados;
+
+    poll_wait(filep, &m->espera_completados, tabla);
+    poll_wait(filep, &m->espera_espacio, tabla);
+    completados = ring_completados(m);
+    if (completados && completados >= READ_ONCE(m->ring->cq_esperando)) mascara |= EPOLLIN | EPOLLRDNORM;
+    if (!kfifo_is_full(&m->cola_comandos)) mascara |= EPOLLOUT | EPOLLWRNORM;
+    return mascara;
+}
+
+// cuando se hace ioctl()
+static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
+    struct mano *m = filep->private_data;
+    unsigned long flags;
+
+    struct rh_config_eje config;
+
+    switch (cmd) {
+    case RH_IOC_DESPERTAR: // El productor vio RH_RING_DESPERTAR despues de llenar sq
+        spin_lock_irqsave(&m->lock, flags);
+        if (ring_hay_trabajo(m)) motor_arrancar(m);
+        spin_unlock_irqrestore(&m->lock, flags);
+        return 0;
+    case RH_IOC_SET_EJE: // Vale desde el proximo pulso, tambien para lo ya encolado
+        if (copy_from_user(&config, (void __user *)arg, sizeof(config))) return -EFAULT;
+        if (config.eje >= RH_NUM_EJES || config.pulso_ms == 0 || config.pulso_ms > U16_MAX ||
+            config.pausa_ms > U16_MAX) {
+            return -EINVAL;
+        }
+        spin_lock_irqsave(&m->lock, flags);
+        m->pulso_ms[config.eje] = config.pulso_ms;
+        m->pausa_ms[config.eje] = config.pausa_ms;
+        spin_unlock_irqrestore(&m->lock, flags);
+        return 0;
+    case RH_IOC_GET_EJE:
+        if (copy_from_user(&config, (void __user *)arg, sizeof(config))) return -EFAULT;
+        if (config.eje >= RH_NUM_EJES) return -EINVAL;
+        spin_lock_irqsave(&m->lock, flags);
+        config.pulso_ms = m->pulso_ms[config.eje];
+        config.pausa_ms = m->pausa_ms[config.eje];
+        spin_unlock_irqrestore(&m->lock, flags);
+        return copy_to_user((void __user *)arg, &config, sizeof(config)) ? -EFAULT : 0;
     default:
-        printk(KERN_WARNING "RoboticTEC Driver: Comando no reconocido '%c'\n", command);
-        break;
+        return -ENOTTY;
     }
-    return 1; // Procesado 1 byte
 }
 
 module_init(robotic_hand_init);
-module_exit(robotic_hand_exit);
\ No newline at end of file
+module_exit(robotic_hand_exit);
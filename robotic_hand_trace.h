@@ -0,0 +1,106 @@
+// Tracepoints del driver RoboticTEC; cada evento lleva el indice de su mano. Apagados
+// cuestan un salto no tomado; se prenden con
+//   echo 1 > /sys/kernel/tracing/events/robotic_hand/enable
+//   cat /sys/kernel/tracing/trace_pipe
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM robotic_hand
+
+#if !defined(_ROBOTIC_HAND_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _ROBOTIC_HAND_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// Origen/forma de cada comando (tambien indexa los contadores de debugfs)
+#ifndef ROBOTIC_HAND_TIPOS
+#define ROBOTIC_HAND_TIPOS
+enum tipo_comando {
+    TIPO_LETRA,     // Letra de write()
+    TIPO_EJES,      // RH_OP_EJES de write()
+    TIPO_PASOS,     // RH_OP_PASOS de write()
+    TIPO_ANILLO,    // Entrada del anillo compartido
+    NUM_TIPOS
+};
+#endif
+
+#define nombres_tipos \
+    { TIPO_LETRA, "letra" }, { TIPO_EJES, "ejes" }, { TIPO_PASOS, "pasos" }, { TIPO_ANILLO, "anillo" }
+
+// Un comando entro a la cola (write) o salio del anillo
+TRACE_EVENT(rh_comando_recibido,
+    TP_PROTO(int mano, u8 tipo, u8 ejes, u16 repeticiones),
+    TP_ARGS(mano, tipo, ejes, repeticiones),
+    TP_STRUCT__entry(
+        __field(int, mano)
+        __field(u8, tipo)
+        __field(u8, ejes)
+        __field(u16, repeticiones)
+    ),
+    TP_fast_assign(
+        __entry->mano = mano;
+        __entry->tipo = tipo;
+        __entry->ejes = ejes;
+        __entry->repeticiones = repeticiones;
+    ),
+    TP_printk("mano=%d tipo=%s ejes=0x%02x repeticiones=%u",
+              __entry->mano, __print_symbolic(__entry->tipo, nombres_tipos), __entry->ejes, __entry->repeticiones)
+);
+
+// Escritura a GPSET0: pines que suben juntos
+TRACE_EVENT(rh_pulso_inicio,
+    TP_PROTO(int mano, u32 pines, u16 repeticiones_restantes),
+    TP_ARGS(mano, pines, repeticiones_restantes),
+    TP_STRUCT__entry(
+        __field(int, mano)
+        __field(u32, pines)
+        __field(u16, repeticiones_restantes)
+    ),
+    TP_fast_assign(
+        __entry->mano = mano;
+        __entry->pines = pines;
+        __entry->repeticiones_restantes = repeticiones_restantes;
+    ),
+    TP_printk("mano=%d pines=0x%08x restantes=%u", __entry->mano, __entry->pines, __entry->repeticiones_restantes)
+);
+
+// Escritura a GPCLR0; latencia_us > 0 si con esto termino el comando (desde write)
+TRACE_EVENT(rh_pulso_fin,
+    TP_PROTO(int mano, u32 pines, u32 latencia_us),
+    TP_ARGS(mano, pines, latencia_us),
+    TP_STRUCT__entry(
+        __field(int, mano)
+        __field(u32, pines)
+        __field(u32, latencia_us)
+    ),
+    TP_fast_assign(
+        __entry->mano = mano;
+        __entry->pines = pines;
+        __entry->latencia_us = latencia_us;
+    ),
+    TP_printk("mano=%d pines=0x%08x latencia_us=%u", __entry->mano, __entry->pines, __entry->latencia_us)
+);
+
+// Comandos esperando en la cola de write() y en el anillo
+TRACE_EVENT(rh_profundidad_cola,
+    TP_PROTO(int mano, u32 cola, u32 anillo),
+    TP_ARGS(mano, cola, anillo),
+    TP_STRUCT__entry(
+        __field(int, mano)
+        __field(u32, cola)
+        __field(u32, anillo)
+    ),
+    TP_fast_assign(
+        __entry->mano = mano;
+        __entry->cola = cola;
+        __entry->anillo = anillo;
+    ),
+    TP_printk("mano=%d cola=%u anillo=%u", __entry->mano, __entry->cola, __entry->anillo)
+);
+
+#endif // _ROBOTIC_HAND_TRACE_H
+
+// El header no esta en include/trace/events: define_trace.h lo busca aca (-I$(src) en el Makefile)
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE robotic_hand_trace
+#include <trace/define_trace.h>